@@ -0,0 +1,139 @@
+#include "BC_ConfigBatch.h"
+#include "BC_Fixed.h"
+
+#define CONFIG_BATCH_MAX_TEMP        10000  // [1/100 °C]
+#define CONFIG_BATCH_MAX_TEMP_DELTA   1000  // [1/100 °C]
+
+/*
+ * The config params that can be changed by a batch, in their scaled integer representation.
+ */
+struct ConfigBatchValues {
+  int32_t targetTemp;
+  int32_t heaterCutOutWaterTemp;
+  int32_t heaterBackOkWaterTemp;
+  int32_t logTempDelta;
+  int32_t logTimeDelta;
+  int32_t tankCapacity;
+  int32_t heaterPower;
+};
+
+static boolean inRange(int32_t value, int32_t min, int32_t max) {
+  return value >= min && value <= max;
+}
+
+static boolean isChanged(uint16_t changed, ConfigParam param) {
+  return changed & (1 << (uint8_t) param);
+}
+
+boolean getConfigBatchValue(ConfigParams *config, uint8_t id, int32_t &value) {
+  switch (ConfigParam(id)) {
+    case ConfigParam::TARGET_TEMP:               value = config->targetTemp; break;
+    case ConfigParam::HEATER_CUT_OUT_WATER_TEMP: value = config->heaterCutOutWaterTemp; break;
+    case ConfigParam::HEATER_BACK_OK_WATER_TEMP: value = config->heaterBackOkWaterTemp; break;
+    case ConfigParam::LOG_TEMP_DELTA:            value = config->logTempDelta; break;
+    case ConfigParam::LOG_TIME_DELTA:            value = config->logTimeDelta; break;
+    case ConfigParam::TANK_CAPACITY:             value = tankCapacityMl(config); break;
+    case ConfigParam::HEATER_POWER:              value = heaterPowerW(config); break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+boolean configValueInRange(uint8_t id, int32_t value) {
+  switch (ConfigParam(id)) {
+    case ConfigParam::TARGET_TEMP:
+    case ConfigParam::HEATER_CUT_OUT_WATER_TEMP:
+    case ConfigParam::HEATER_BACK_OK_WATER_TEMP:
+      return inRange(value, 0, CONFIG_BATCH_MAX_TEMP);
+    case ConfigParam::LOG_TEMP_DELTA:
+      return inRange(value, 1, CONFIG_BATCH_MAX_TEMP_DELTA);
+    case ConfigParam::LOG_TIME_DELTA:
+      return inRange(value, 1, UINT16_MAX);
+    case ConfigParam::TANK_CAPACITY:
+      return inRange(value, 1, MAX_TANK_CAPACITY);
+    case ConfigParam::HEATER_POWER:
+      return inRange(value, 1, MAX_HEATER_POWER);
+    default:
+      return false;
+  }
+}
+
+void ConfigBatch::clear() {
+  count = 0;
+  overflow = false;
+  malformed = false;
+}
+
+boolean ConfigBatch::add(uint8_t id, int32_t value) {
+  if (count == CONFIG_BATCH_MAX_ITEMS) {
+    overflow = true;
+    return false;
+  }
+  items[count].id = id;
+  items[count].value = value;
+  count++;
+  return true;
+}
+
+ConfigBatchResult ConfigBatch::apply(ExecutionContext *context, UserCommands accepted) {
+  ConfigParams *config = context->config;
+  ConfigBatchValues v;
+  v.targetTemp = config->targetTemp;
+  v.heaterCutOutWaterTemp = config->heaterCutOutWaterTemp;
+  v.heaterBackOkWaterTemp = config->heaterBackOkWaterTemp;
+  v.logTempDelta = config->logTempDelta;
+  v.logTimeDelta = config->logTimeDelta;
+  v.tankCapacity = tankCapacityMl(config);
+  v.heaterPower = heaterPowerW(config);
+
+  ConfigBatchResult result = CONFIG_BATCH_OK;
+  uint16_t changed = 0;
+  if (malformed) {
+    result = CONFIG_BATCH_MALFORMED;
+  } else if (!(accepted & CMD_CONFIG_SET_VALUE)) {
+    result = CONFIG_BATCH_NOT_ACCEPTED;
+  } else if (overflow) {
+    result = CONFIG_BATCH_OVERFLOW;
+  } else if (count == 0) {
+    result = CONFIG_BATCH_EMPTY;
+  }
+  for (uint8_t i = 0; i < count && result == CONFIG_BATCH_OK; i++) {
+    int32_t value = items[i].value;
+    switch (ConfigParam(items[i].id)) {
+      case ConfigParam::TARGET_TEMP:               v.targetTemp = value; break;
+      case ConfigParam::HEATER_CUT_OUT_WATER_TEMP: v.heaterCutOutWaterTemp = value; break;
+      case ConfigParam::HEATER_BACK_OK_WATER_TEMP: v.heaterBackOkWaterTemp = value; break;
+      case ConfigParam::LOG_TEMP_DELTA:            v.logTempDelta = value; break;
+      case ConfigParam::LOG_TIME_DELTA:            v.logTimeDelta = value; break;
+      case ConfigParam::TANK_CAPACITY:             v.tankCapacity = value; break;
+      case ConfigParam::HEATER_POWER:              v.heaterPower = value; break;
+      default:
+        result = CONFIG_BATCH_UNKNOWN_PARAM;
+        continue;
+    }
+    if (!configValueInRange(items[i].id, value)) {
+      result = CONFIG_BATCH_ILLEGAL_VALUE;
+    }
+    changed |= 1 << items[i].id;
+  }
+  if (result == CONFIG_BATCH_OK
+      && (v.heaterBackOkWaterTemp >= v.heaterCutOutWaterTemp || v.targetTemp > v.heaterCutOutWaterTemp)) {
+    result = CONFIG_BATCH_INCONSISTENT;
+  }
+
+  if (result == CONFIG_BATCH_OK) {
+    // write back the received params only: the others keep their exact values (e.g. fractional float params):
+    if (isChanged(changed, ConfigParam::TARGET_TEMP))               config->targetTemp = v.targetTemp;
+    if (isChanged(changed, ConfigParam::HEATER_CUT_OUT_WATER_TEMP)) config->heaterCutOutWaterTemp = v.heaterCutOutWaterTemp;
+    if (isChanged(changed, ConfigParam::HEATER_BACK_OK_WATER_TEMP)) config->heaterBackOkWaterTemp = v.heaterBackOkWaterTemp;
+    if (isChanged(changed, ConfigParam::LOG_TEMP_DELTA))            config->logTempDelta = v.logTempDelta;
+    if (isChanged(changed, ConfigParam::LOG_TIME_DELTA))            config->logTimeDelta = v.logTimeDelta;
+    if (isChanged(changed, ConfigParam::TANK_CAPACITY))             config->tankCapacity = v.tankCapacity;
+    if (isChanged(changed, ConfigParam::HEATER_POWER))              config->heaterPower = v.heaterPower;
+    config->save();
+    context->log->logMessage(static_cast<T_Message_ID>(BC_Msg::CONFIG_BATCH), changed, count);
+  }
+  clear();
+  return result;
+}
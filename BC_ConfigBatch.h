@@ -0,0 +1,77 @@
+#ifndef BC_CONFIG_BATCH_H_INCLUDED
+  #define BC_CONFIG_BATCH_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include "BC_Messages.h"
+
+  #define CONFIG_BATCH_MAX_ITEMS NUM_CONFIG_PARAMS
+
+  /*
+   * One (param, value) pair of a batch. Values are scaled integers:
+   * temperatures [1/100 °C], log time delta [s], tank capacity [ml], heater power [W].
+   */
+  struct ConfigBatchItem {
+    uint8_t id;
+    int32_t value;
+  } __attribute__((packed));
+
+  enum ConfigBatchResult : uint8_t {
+    CONFIG_BATCH_OK = 0,
+    CONFIG_BATCH_EMPTY,
+    CONFIG_BATCH_OVERFLOW,
+    CONFIG_BATCH_UNKNOWN_PARAM,
+    CONFIG_BATCH_ILLEGAL_VALUE,
+    CONFIG_BATCH_INCONSISTENT,
+    CONFIG_BATCH_MALFORMED,
+    CONFIG_BATCH_NOT_ACCEPTED
+  };
+
+  /*
+   * Reads a config param in its ConfigBatchItem representation. Returns false for params that cannot be batched.
+   */
+  boolean getConfigBatchValue(ConfigParams *config, uint8_t id, int32_t &value);
+
+  /*
+   * Range check of a single config param value in its ConfigBatchItem representation (without the consistency
+   * checks across params). Returns false for params that cannot be batched.
+   */
+  boolean configValueInRange(uint8_t id, int32_t value);
+
+  /*
+   * Collects several config param changes and applies them all-or-nothing: every value is validated, the resulting
+   * configuration is checked for consistency, then all params are written with a single ConfigParams::save() and
+   * recorded by a single log message (BC_Msg::CONFIG_BATCH) instead of one CONFIG entry per param.
+   * The sensor IDs cannot be changed by a batch.
+   */
+  class ConfigBatch {
+    public:
+      ConfigBatch() {}
+
+      void clear();
+
+      /*
+       * Returns false if the batch is full (the batch is then rejected by apply()).
+       */
+      boolean add(uint8_t id, int32_t value);
+
+      uint8_t size() { return count; }
+
+      /*
+       * Marks the batch as incomplete (e.g. a fragment could not be decoded); it is rejected by apply().
+       */
+      void reject() { malformed = true; }
+
+      /*
+       * Validates and applies the batch, then clears it. Like a single config change, the batch is only applied if
+       * the automaton currently accepts CMD_CONFIG_SET_VALUE (see BoilerStateAutomaton::acceptedUserCommands()).
+       */
+      ConfigBatchResult apply(ExecutionContext *context, UserCommands accepted);
+
+    protected:
+      ConfigBatchItem items[CONFIG_BATCH_MAX_ITEMS];
+      uint8_t count = 0;
+      boolean overflow = false;
+      boolean malformed = false;
+  };
+
+#endif
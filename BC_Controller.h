@@ -2,6 +2,12 @@
 #include <ACF_Messages.h>
 #include <BC_Control.h>
 #include "BC_UI.h"
+#include "BC_CutOutGuard.h"
+#include "BC_SensorReadout.h"
+#include "BC_Idle.h"
+#include "BC_Memory.h"
+#include "BC_Fixed.h"
+#include "BC_WarmRestart.h"
 
 // #define DEBUG_MAIN
 
@@ -22,6 +28,7 @@
 #define MIN_USER_NOTIFICATION_INTERVAL  1000L // [ms] (notification only happens if relevant changes occurred)
 #define MAX_USER_NOTIFICATION_INTERVAL 10000L // [ms] notify user after this period at the latest
 #define NOTIFICATION_TEMP_DELTA           20  // [°C * 100]
+#define HEATING_LOOP_PERIOD              100L // [ms] max. loop period while heating or while the heater is on
 
 enum class SensorManagementCycle {
   STAGE_0 = 0,  // init sensor readout
@@ -31,14 +38,29 @@ enum class SensorManagementCycle {
 };
 
 
+/*
+ * The controller is bound to its UI type at compile time so the UI calls on the hot path (readUserRequest, 
+ * notifyStatusChange, notifyNewLogEntry, ...) are resolved statically and can be inlined when UI is a final class.
+ * BC_Controller<AbstractUI> dispatches dynamically, e.g. for setups that switch or combine UIs.
+ */
+template<class UI = AbstractUI>
 class BC_Controller {
   protected:
 
     FRAMStore configStore = FRAMStore(sizeof(ConfigParams));
-    FRAMStore logStore = FRAMStore(&configStore, 1024);
+    FRAMStore logStore = FRAMStore(&configStore, LOG_STORE_SIZE);
+    FRAMStore heaterControlStore = FRAMStore(&logStore, PersistentBlock<HeaterControlParams>::STORE_SIZE);
+    FRAMStore logIndexStore = FRAMStore(&heaterControlStore, LOG_INDEX_STORE_SIZE);
+    FRAMStore rollupStore = FRAMStore(&logIndexStore, ROLLUP_STORE_SIZE);
+    FRAMStore uiStore = FRAMStore(&rollupStore, UI_STORE_SIZE);
+    FRAMStore flightRecorderStore = FRAMStore(&uiStore, FLIGHT_RECORDER_STORE_SIZE);
+    FRAMStore warmRestartStore = FRAMStore(&flightRecorderStore, WARM_RESTART_STORE_SIZE);
+    FRAMStore preheatStore = FRAMStore(&warmRestartStore, PREHEAT_STORE_SIZE);
+    FRAMStore energyStore = FRAMStore(&preheatStore, ENERGY_STORE_SIZE);
     
     ConfigParams configParams = ConfigParams(&configStore);
     Log logger = Log(&logStore); 
+    LogTypeIndex logIndex = LogTypeIndex(&logIndexStore, &logger);
     
     OperationalParams opParams = OperationalParams();
     
@@ -46,18 +68,38 @@ class BC_Controller {
     
     OneWire oneWire = OneWire(ONE_WIRE_PIN);  // on pin 10 (a 4.7K pull-up resistor to +5V is necessary)
     DS18B20_Controller controller = DS18B20_Controller(&oneWire, sensors, 2);
+    CutOutGuard cutOutGuard = CutOutGuard();
+    SensorReadout sensorReadout = SensorReadout();
+    HeaterControl heaterControl = HeaterControl(&heaterControlStore);
+    Rollups rollups = Rollups(&rollupStore);
+    FlightRecorder flightRecorder = FlightRecorder(&flightRecorderStore);
+    WarmRestart warmRestart = WarmRestart(&warmRestartStore);
+    PreheatScheduler scheduler = PreheatScheduler(&preheatStore);
+    EnergyMeter energy = EnergyMeter(&energyStore);
     
     ExecutionContext context = ExecutionContext();
     BoilerStateAutomaton automaton = BoilerStateAutomaton();
     
-    ControlActions *controlActions = NULL;
-    AbstractUI *ui = NULL;
+    UI *ui;
+    ControlActions controlActions;
+    
+    TimeMillis sensorCycleStart = 0L;
+    SensorManagementCycle sensorCycle = SensorManagementCycle::STAGE_0;
+    TimeMillis lastUserNotificationCheck = 0L;
+    
+    RuntimeStats stats = RuntimeStats();
+    RuntimeContext runtime = { &automaton, &stats, &heaterControl, &logIndex, &rollups, &uiStore, &flightRecorder, &scheduler, &energy, &sensorReadout };
 
   public:
-    BC_Controller() {}
+    BC_Controller(UI *ui) : ui(ui), controlActions(&context, ui) {}
     
-    void init(AbstractUI *ui) {
-      this->ui = ui;
+    void init() {
+      TimeMillis initStart = millis();
+      ResetCause resetCause = readResetCause();
+      
+      // keep the heater off while the log and config are being restored:
+      digitalWrite(HEATER_PIN, LOW);
+      pinMode(HEATER_PIN, OUTPUT);
       
       bool connected = configStore.init();
       if(!connected) {
@@ -65,7 +107,13 @@ class BC_Controller {
         write_S_O_S(F("FRAM not connected"), __LINE__);
       }
       
+      TimeMillis logInitStart = millis();
+      // TODO: restore the log from a persisted head/tail checkpoint in constant time, scanning only if the
+      // checkpoint is invalid. Log::init() and the log's cursors live in the control library, which has no API
+      // for that yet; until it does, the restore time is only reported ('stat').
       logger.init();
+      logIndex.init();
+      stats.logInitMillis = millis() - logInitStart;
       logger.logMessage(static_cast<T_Message_ID>(ACF_Msg::SYSTEM_INIT), 0, 0);
     
       // Erease the config params (do this e.g. after the physical layout has changed)
@@ -75,30 +123,38 @@ class BC_Controller {
       
       configParams.load(); 
       
-      controlActions = new ControlActions(&context, ui);
-    
       context.log = &logger;
       context.config = &configParams;
       context.op = &opParams;
       context.controller = &controller;
-      context.control = controlActions;
+      context.control = &controlActions;
     
       automaton.init(&context);
       
-      pinMode(HEATER_PIN, OUTPUT);
+      // TODO: fast start: address the configured (acknowledged) ROM IDs directly and verify each with one read,
+      // searching the bus only on a mismatch. setupSensors() and the matching live in the control library, which
+      // always searches the bus; until it has such an API, only the first conversion is started early (below).
       context.control->setupSensors();
+      // start the first conversion right away so it completes while the UI is being initialised:
+      context.control->initSensorReadout();
+      sensorCycleStart = millis();
+      sensorCycle = SensorManagementCycle::STAGE_1;
+      cutOutGuard.init(&context, &oneWire);
+      sensorReadout.init(&context, &oneWire);
+      heaterControl.init(&context);
+      rollups.init();
+      stats.warmRestart = warmRestart.init(&context, resetCause);
+      scheduler.init(&context);
+      energy.init(&context, currentDay(millis()));
       
       context.op->request.clear();
       
-      ui->init(&context);
+      ui->init(&context, &runtime);
+      stats.initMillis = millis() - initStart;
     }  
     
 
     void loop() {
-      static TimeMillis sensorCycleStart = 0L;
-      static SensorManagementCycle sensorCycle = SensorManagementCycle::STAGE_0;
-      static TimeMillis lastUserNotificationCheck = 0L;
-      
       TimeMillis now = millis();
       TimeMillis elapsed = now - sensorCycleStart;
       if (sensorCycleStart == 0L || elapsed >= SENSOR_CYCLE_DURATION) {
@@ -113,18 +169,36 @@ class BC_Controller {
         
       } else if (sensorCycle == SensorManagementCycle::STAGE_1 && elapsed >= TEMP_SENSOR_READOUT_WAIT) {
         sensorCycle = SensorManagementCycle::STAGE_2;
+        sensorReadout.beforeReadout();
         context.control->completeSensorReadout();
+        sensorReadout.afterReadout();
+        if (stats.firstWaterTempMillis == 0L && context.op->water.sensorStatus == DS18B20_SENSOR_OK) {
+          stats.firstWaterTempMillis = millis();
+        }
+        updateRollups(&context, now);
+        recordFlightSample(now);
+        scheduler.update(now, digitalRead(HEATER_PIN) == HIGH);
         
       } else if (sensorCycle == SensorManagementCycle::STAGE_2) {
         sensorCycle = SensorManagementCycle::STAGE_3;
         logTemperatureValues(&context);
       }
+      
+      // the regular readout does not use the bus in the idle stage:
+      TimeMillis busFreeMillis = sensorCycle == SensorManagementCycle::STAGE_3 ? SENSOR_CYCLE_DURATION - elapsed : 0L;
+      cutOutGuard.update(now, busFreeMillis);
     
       if (context.op->request.command == CMD_NONE) {
-        ui->readUserRequest();
+        UserCommandEnum resume = warmRestart.resumeCommand(&automaton, now);
+        if (resume != CMD_NONE) {
+          context.op->request.setCommand(resume);
+        } else if (! scheduler.nextRequest(&automaton, &context.op->request)) {
+          ui->readUserRequest();
+        }
         context.op->request.event = automaton.commandToEvent(context.op->request.command);
       }
     
+      boolean busy = false;
       EventSet cand = automaton.evaluate(context.op->request.event);
       if (cand != Events::NONE) {
         Event event = processEventCandidates(cand);
@@ -134,7 +208,14 @@ class BC_Controller {
             Serial.println(event.name());
           #endif
           
+          StateID previous = automaton.state()->id();
           automaton.transition(event);
+          busy = true;
+          if (automaton.state()->id() == States::OVERHEATED && previous != States::OVERHEATED) {
+            // cut-out by the regular readout or by the guard:
+            recordFlightSample(now);
+            flightRecorder.freeze(FAULT_HEATER_CUT_OUT, now);
+          }
           
           #ifdef DEBUG_MAIN
             Serial.print(F("DEBUG_MAIN: Processed event: " );
@@ -145,6 +226,8 @@ class BC_Controller {
             // the user's command was chosen as the event with the highest priority
             
             if (context.op->request.event == Events::INFO) {
+              // the log index must be up to date for log queries:
+              checkForNewLogEntries(&context);
               ui->provideUserInfo(&automaton);
             }
           }
@@ -152,17 +235,66 @@ class BC_Controller {
       }
       
       context.op->request.clear();
+      
+      heaterControl.update(now, automaton.state()->id() == States::HEATING);
+      warmRestart.update(&automaton, now);
+      energy.update(now, digitalRead(HEATER_PIN) == HIGH, currentDay(now));
     
       if (now - lastUserNotificationCheck >= MIN_USER_NOTIFICATION_INTERVAL) {
         checkForStatusChange(&context, &automaton, now);
         checkForNewLogEntries(&context);
         lastUserNotificationCheck = now;
       }
+      ui->update();
+      
+      // write the staged log index entries when there's nothing else to do:
+      if (! busy && logIndex.flushDue(now)) {
+        logIndex.flush();
+      }
       
-      delay(100);
+      // sleep until the next deadline of the sensor cycle, user notification or heater control:
+      TimeMillis deadline = lastUserNotificationCheck + MIN_USER_NOTIFICATION_INTERVAL;
+      if (sensorCycle == SensorManagementCycle::STAGE_1) {
+        deadline = earliest(deadline, sensorCycleStart + TEMP_SENSOR_READOUT_WAIT);
+      } else if (sensorCycle == SensorManagementCycle::STAGE_2) {
+        deadline = now;
+      } else {
+        deadline = earliest(deadline, sensorCycleStart + SENSOR_CYCLE_DURATION);
+      }
+      if (digitalRead(HEATER_PIN) == HIGH || automaton.state()->id() == States::HEATING) {
+        deadline = earliest(deadline, now + HEATING_LOOP_PERIOD);
+      }
+      idle(earliest(deadline, now + ui->maxIdleMillis()));
     }
 
   protected:
+    /*
+     * Day number for the daily energy counter, ENERGY_DAY_UNKNOWN until the clock has been set.
+     */
+    uint16_t currentDay(TimeMillis now) {
+      return scheduler.clockSet() ? scheduler.dayNumber(now) : ENERGY_DAY_UNKNOWN;
+    }
+    
+    static TimeMillis earliest(TimeMillis t1, TimeMillis t2) {
+      // wrap-around safe:
+      return (int32_t) (t1 - t2) < 0 ? t1 : t2;
+    }
+    
+    /*
+     * Puts the MCU to sleep until the deadline has passed or until the UI has input pending.
+     */
+    void idle(TimeMillis deadline) {
+      TimeMillis start = millis();
+      if ((int32_t) (deadline - start) <= 0) {
+        return;
+      }
+      while ((int32_t) (deadline - millis()) > 0 && ! ui->inputPending()) {
+        idleSleep();
+      }
+      stats.sleepMillis += millis() - start;
+      stats.sleepCount++;
+    }
+    
     Event processEventCandidates(EventSet candidates) {
       #ifdef DEBUG_MAIN
         Serial.print(F("DEBUG_MAIN: evaluation yields event candidates: 0x"));
@@ -226,6 +358,21 @@ class BC_Controller {
     }
     
     
+    void recordFlightSample(TimeMillis now) {
+      flightRecorder.record(now, &opParams.water, &opParams.ambient, digitalRead(HEATER_PIN) == HIGH, (uint8_t) automaton.state()->id().id());
+    }
+    
+    void updateRollups(ExecutionContext *context, TimeMillis now) {
+      DS18B20_Sensor *water = &context->op->water;
+      DS18B20_Sensor *ambient = &context->op->ambient;
+      rollups.update(now, 
+        water->sensorStatus == DS18B20_SENSOR_OK ? water->currentTemp : ACF_UNDEFINED_TEMPERATURE,
+        ambient->sensorStatus == DS18B20_SENSOR_OK ? ambient->currentTemp : ACF_UNDEFINED_TEMPERATURE,
+        heaterControl.onMillis,
+        heaterPowerW(context->config));
+    }
+    
+    
     void checkForStatusChange(ExecutionContext *context, BoilerStateAutomaton *automaton, TimeMillis now) {
       // timepoint [ms] when this (= most recent) notification was sent to user:
       static TimeMillis notificationTimeMillis;
@@ -293,7 +440,7 @@ class BC_Controller {
         TimeSeconds timeToGo;
         if (currentState == States::IDLE || (currentState == States::STANDBY && heatingTotalMillis(context->op) == 0)) { // we're recording but haven't started heating yet
           // the original time to go is only calculated in state IDLE:
-          context->op->originalTimeToGo = context->originalTimeToGo();
+          context->op->originalTimeToGo = originalTimeToGo(context);
           timeToGo = context->op->originalTimeToGo;
         } else if (NOTIFY_TIME_HEATING) {
           timeToGo = context->op->originalTimeToGo - notification.heatingTime;
@@ -319,8 +466,17 @@ class BC_Controller {
       context->log->readUnnotifiedLogEntries();
       LogEntry e;
       while (context->log->nextLogEntry(e)) {
+        logIndex.append(e);
         ui->notifyNewLogEntry(e);
       }
     }
 };
 
+
+static_assert(sizeof(LogTypeIndex) <= RAM_BUDGET_LOGGING, "logging exceeds its RAM budget");
+static_assert(sizeof(HeaterControl) + sizeof(CutOutGuard) <= RAM_BUDGET_HEATER, "heater control exceeds its RAM budget");
+static_assert(sizeof(SensorReadout) <= RAM_BUDGET_SENSORS, "sensor readout exceeds its RAM budget");
+static_assert(sizeof(Rollups) <= RAM_BUDGET_ROLLUPS, "rollups exceed their RAM budget");
+static_assert(sizeof(FlightRecorder) <= RAM_BUDGET_FLIGHT_RECORDER, "flight recorder exceeds its RAM budget");
+static_assert(sizeof(PreheatScheduler) <= RAM_BUDGET_SCHEDULER, "scheduler exceeds its RAM budget");
+static_assert(sizeof(EnergyMeter) <= RAM_BUDGET_ENERGY, "energy meter exceeds its RAM budget");
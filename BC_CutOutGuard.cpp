@@ -0,0 +1,84 @@
+#include "BC_CutOutGuard.h"
+
+// #define DEBUG_CUT_OUT
+
+void CutOutGuard::init(ExecutionContext *context, OneWire *oneWire) {
+  this->context = context;
+  this->oneWire = oneWire;
+}
+
+boolean CutOutGuard::heaterOn() {
+  return digitalRead(HEATER_PIN) == HIGH;
+}
+
+boolean CutOutGuard::update(TimeMillis now, TimeMillis busFreeMillis) {
+  const uint8_t *rom = (const uint8_t *) &context->config->waterTempSensorId;
+
+  if (converting) {
+    if (now - conversionStart < ds18b20ConversionMillis(FAST_CUT_OUT_RESOLUTION)) {
+      return false;
+    }
+    converting = false;
+    lastReadout = now;
+    if (! completeReadout(rom)) {
+      failedReadouts++;
+      return false;
+    }
+    readouts++;
+
+    if (heaterOn() && lastTemp >= context->config->heaterCutOutWaterTemp) {
+      digitalWrite(HEATER_PIN, LOW);
+      // let the automaton see the overheating => cut-out transition:
+      context->op->water.currentTemp = lastTemp;
+      trips++;
+      #ifdef DEBUG_CUT_OUT
+        Serial.print(F("DEBUG_CUT_OUT: heater cut out at "));
+        Serial.println(lastTemp);
+      #endif
+      return true;
+    }
+    return false;
+  }
+
+  if (! heaterOn() || context->op->water.sensorStatus != DS18B20_SENSOR_OK) {
+    return false;
+  }
+  if (now - lastReadout < FAST_CUT_OUT_INTERVAL) {
+    return false;
+  }
+  if (busFreeMillis < ds18b20ConversionMillis(FAST_CUT_OUT_RESOLUTION) + FAST_CUT_OUT_MARGIN) {
+    return false;
+  }
+  if (startReadout(rom)) {
+    converting = true;
+    conversionStart = now;
+  } else {
+    failedReadouts++;
+    lastReadout = now;
+  }
+  return false;
+}
+
+boolean CutOutGuard::startReadout(const uint8_t rom[]) {
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  if (! ds18b20ReadScratchpad(oneWire, rom, scratchpad)) {
+    return false;
+  }
+  if (! ds18b20SetResolution(oneWire, rom, scratchpad, FAST_CUT_OUT_RESOLUTION)) {
+    return false;
+  }
+  return ds18b20StartConversion(oneWire, rom);
+}
+
+boolean CutOutGuard::completeReadout(const uint8_t rom[]) {
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  boolean ok = ds18b20ReadScratchpad(oneWire, rom, scratchpad);
+  if (ok) {
+    lastTemp = ds18b20Temperature(scratchpad);
+  }
+  // restore the full resolution for the regular sensor readout (alarm bytes are only valid if the read succeeded):
+  if (ok || ds18b20ReadScratchpad(oneWire, rom, scratchpad)) {
+    ds18b20SetResolution(oneWire, rom, scratchpad, DS18B20_RESOLUTION_12_BIT);
+  }
+  return ok;
+}
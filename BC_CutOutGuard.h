@@ -0,0 +1,51 @@
+#ifndef BC_CUT_OUT_GUARD_H_INCLUDED
+  #define BC_CUT_OUT_GUARD_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include "BC_Sensors.h"
+
+  #define FAST_CUT_OUT_INTERVAL      500L // [ms] min. time between two fast readouts of the water sensor
+  #define FAST_CUT_OUT_MARGIN        250L // [ms] readouts must complete this long before the next regular sensor readout starts
+  #define FAST_CUT_OUT_RESOLUTION    DS18B20_RESOLUTION_9_BIT
+
+  /*
+   * Fast-path protection against overheating: while the heater is on, the water sensor is read at low resolution in the
+   * idle part of every sensor-management cycle. When the heater cut-out temperature is reached, the heater pin is dropped
+   * immediately and the water temperature is updated so that the automaton performs the cut-out transition in the same
+   * loop iteration, i.e. well before the next regular sensor readout.
+   */
+  class CutOutGuard {
+    public:
+      CutOutGuard() {}
+
+      void init(ExecutionContext *context, OneWire *oneWire);
+
+      /*
+       * Call from every loop iteration. busFreeMillis is the time [ms] the OneWire bus remains unused by the regular
+       * sensor readout (0 if the regular readout is in progress).
+       * Returns true if the heater has just been cut out.
+       */
+      boolean update(TimeMillis now, TimeMillis busFreeMillis);
+
+      // number of fast readouts since boot:
+      uint32_t readouts = 0L;
+      // number of fast readouts that failed (no response or CRC error):
+      uint16_t failedReadouts = 0;
+      // number of cut-outs triggered by the guard:
+      uint16_t trips = 0;
+      // most recent fast readout of the water temperature:
+      ACF_Temperature lastTemp = ACF_UNDEFINED_TEMPERATURE;
+
+    protected:
+      ExecutionContext *context = NULL;
+      OneWire *oneWire = NULL;
+      boolean converting = false;
+      TimeMillis conversionStart = 0L;
+      TimeMillis lastReadout = 0L;
+
+      boolean heaterOn();
+      boolean startReadout(const uint8_t rom[]);
+      boolean completeReadout(const uint8_t rom[]);
+  };
+
+#endif
@@ -0,0 +1,84 @@
+#include "BC_Energy.h"
+
+void EnergyMeter::init(ExecutionContext *context, uint16_t day) {
+  this->context = context;
+  if (!persistent.load(counters)) {
+    counters = EnergyCounters();
+  }
+  loggingValues = context->op->loggingValues;
+  if (day == ENERGY_DAY_UNKNOWN || counters.day != day) {
+    // a restart has no idea of the time elapsed:
+    counters.dayWh = 0L;
+    counters.day = day;
+  }
+}
+
+uint32_t accumulateWh(uint32_t &remainder, uint32_t power, TimeMillis duration) {
+  // [W] * [ms] = [mJ]; 64 bits for long periods at high power
+  uint64_t energy = (uint64_t) power * duration + remainder;
+  remainder = energy % MILLIJOULES_PER_WH;
+  return energy / MILLIJOULES_PER_WH;
+}
+
+void EnergyMeter::integrate(TimeMillis now) {
+  uint32_t wh = accumulateWh(counters.remainder, heaterPowerW(context->config), now - onSince);
+  counters.sessionWh += wh;
+  if (dayKnown()) {
+    counters.dayWh += wh;
+  }
+  counters.lifetimeWh += wh;
+  onSince = now;
+  dirty = true;
+}
+
+void EnergyMeter::checkpoint(TimeMillis now) {
+  persistent.save(counters);
+  lastSave = now;
+  dirty = false;
+}
+
+void EnergyMeter::logEnergy(BC_Msg msg, uint32_t wh) {
+  context->log->logMessage(static_cast<T_Message_ID>(msg), min(wh, (uint32_t) INT16_MAX),
+                           min((uint32_t) (counters.lifetimeWh / 1000L), (uint32_t) INT16_MAX));
+}
+
+void EnergyMeter::update(TimeMillis now, boolean heaterOn, uint16_t day) {
+  if (heaterOn != this->heaterOn) {
+    if (heaterOn) {
+      onSince = now;
+    } else {
+      integrate(now);
+    }
+    this->heaterOn = heaterOn;
+  } else if (heaterOn && now - onSince >= ENERGY_INTEGRATION_INTERVAL) {
+    integrate(now);
+  }
+
+  if (context->op->loggingValues != loggingValues) {
+    loggingValues = context->op->loggingValues;
+    if (loggingValues) {
+      counters.sessionWh = 0L;
+      dirty = true;
+    } else {
+      // the session has ended ('rec off'):
+      if (heaterOn) {
+        integrate(now);
+      }
+      logEnergy(BC_Msg::ENERGY_SESSION, counters.sessionWh);
+      checkpoint(now);
+    }
+  }
+  if (day != counters.day) {
+    // setting the clock after boot starts the first day, it does not end one:
+    if (dayKnown()) {
+      logEnergy(BC_Msg::ENERGY_DAY, counters.dayWh);
+    }
+    counters.dayWh = 0L;
+    counters.day = day;
+    dirty = true;
+  }
+
+  if (dirty && now - lastSave >= ENERGY_MIN_SAVE_INTERVAL && (!heaterOn || now - lastSave >= ENERGY_CHECKPOINT_INTERVAL)) {
+    checkpoint(now);
+  }
+}
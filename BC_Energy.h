@@ -0,0 +1,73 @@
+#ifndef BC_ENERGY_H_INCLUDED
+  #define BC_ENERGY_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include "BC_Persistent.h"
+  #include "BC_Messages.h"
+  #include "BC_Fixed.h"
+
+  #define ENERGY_INTEGRATION_INTERVAL   60000L // [ms] a running heater is integrated at least this often
+  #define ENERGY_MIN_SAVE_INTERVAL      60000L // [ms] min. time between two checkpoints
+  #define ENERGY_CHECKPOINT_INTERVAL   600000L // [ms] checkpoint while the heater is on
+  #define MILLIJOULES_PER_WH          3600000L
+  #define ENERGY_DAY_UNKNOWN             0xFFFF  // the clock has not been set since boot
+
+  struct EnergyCounters {
+    uint32_t sessionWh = 0L;
+    uint32_t dayWh = 0L;
+    uint32_t lifetimeWh = 0L;
+    // energy not yet counted as a full Wh [mJ]:
+    uint32_t remainder = 0L;
+    // day the dayWh belongs to (see PreheatScheduler::dayNumber()):
+    uint16_t day = ENERGY_DAY_UNKNOWN;
+  };
+
+  #define ENERGY_STORE_SIZE (PersistentBlock<EnergyCounters>::STORE_SIZE)
+
+  /*
+   * Adds the energy of power [W] over duration [ms] to remainder [mJ] and takes the full Wh out of it again, i.e.
+   * no energy is lost however finely a heater-on period is split. Returns the full Wh.
+   */
+  uint32_t accumulateWh(uint32_t &remainder, uint32_t power, TimeMillis duration);
+
+  /*
+   * Energy used by the heater, integrated from the heater-on time and the configured heater power on every heater
+   * transition (and at least every ENERGY_INTEGRATION_INTERVAL while the heater is on).
+   * - session: since the most recent start of recording ('rec on'), logged (BC_Msg::ENERGY_SESSION) and checkpointed
+   *   when recording stops,
+   * - day: since midnight; only known once the clock has been set after boot (see PreheatScheduler), the day
+   *   counter is invalid (and not counted) until then. There is no RTC, so the counter restarts with every boot.
+   * - lifetime: since the FRAM was initialised.
+   * The counters are checkpointed to FRAM (double-buffered) when the heater is switched off and every
+   * ENERGY_CHECKPOINT_INTERVAL while it is on, but never more often than every ENERGY_MIN_SAVE_INTERVAL.
+   */
+  class EnergyMeter {
+    public:
+      EnergyMeter(FRAMStore *store) : persistent(store) {}
+
+      void init(ExecutionContext *context, uint16_t day);
+
+      /*
+       * Call from every loop iteration. day is ENERGY_DAY_UNKNOWN while the clock is not set.
+       */
+      void update(TimeMillis now, boolean heaterOn, uint16_t day);
+
+      EnergyCounters counters;
+
+      boolean dayKnown() { return counters.day != ENERGY_DAY_UNKNOWN; }
+
+    protected:
+      PersistentBlock<EnergyCounters> persistent;
+      ExecutionContext *context = NULL;
+      boolean heaterOn = false;
+      boolean loggingValues = false;
+      TimeMillis onSince = 0L;
+      TimeMillis lastSave = 0L;
+      boolean dirty = false;
+
+      void integrate(TimeMillis now);
+      void checkpoint(TimeMillis now);
+      void logEnergy(BC_Msg msg, uint32_t wh);
+  };
+
+#endif
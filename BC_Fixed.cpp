@@ -0,0 +1,109 @@
+#include "BC_Fixed.h"
+
+uint32_t tankCapacityMl(ConfigParams *config) {
+  if (!(config->tankCapacity > 0)) {
+    return 0L;
+  }
+  return config->tankCapacity < MAX_TANK_CAPACITY ? (uint32_t) config->tankCapacity : MAX_TANK_CAPACITY;
+}
+
+uint32_t heaterPowerW(ConfigParams *config) {
+  if (!(config->heaterPower > 0)) {
+    return 0L;
+  }
+  return config->heaterPower < MAX_HEATER_POWER ? (uint32_t) config->heaterPower : MAX_HEATER_POWER;
+}
+
+int32_t heatingEnergy(uint32_t capacity, int32_t delta) {
+  // [ml] * [°C * 100] * [mJ / (ml * K)] / 100'000 = [J]; at most 1e6 * 2^16 * 4186 => needs 64 bits
+  uint32_t magnitude = delta < 0 ? - (uint32_t) delta : delta;
+  int32_t energy = (uint64_t) capacity * magnitude * WATER_HEAT_CAPACITY / 100000L;
+  return delta < 0 ? -energy : energy;
+}
+
+TimeSeconds originalTimeToGo(ExecutionContext *context) {
+  uint32_t power = heaterPowerW(context->config);
+  DS18B20_Sensor *water = &context->op->water;
+  if (power == 0 || (water->sensorStatus != DS18B20_SENSOR_OK && water->sensorStatus != DS18B20_SENSOR_ID_AUTO_ASSIGNED)) {
+    return UNDEFINED_TIME_SECONDS;
+  }
+  int32_t delta = (int32_t) context->config->targetTemp - water->currentTemp;
+  if (delta <= 0) {
+    return 0L;
+  }
+  return heatingEnergy(tankCapacityMl(context->config), delta) / power;
+}
+
+char *formatFixed(int32_t value, uint8_t decimals, char buf[]) {
+  char digits[12];
+  uint8_t n = 0;
+  uint32_t v = value < 0 ? - (uint32_t) value : value;
+  // least significant digit first, at least one digit before the decimal point:
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v > 0 || n <= decimals);
+
+  uint8_t i = 0;
+  if (value < 0) {
+    buf[i++] = '-';
+  }
+  while (n > 0) {
+    if (n == decimals) {
+      buf[i++] = '.';
+    }
+    buf[i++] = digits[--n];
+  }
+  buf[i] = '\0';
+  return buf;
+}
+
+boolean parseFixed(const char *s, uint8_t decimals, int32_t min, int32_t max, int32_t &value) {
+  boolean negative = *s == '-';
+  if (*s == '-' || *s == '+') {
+    s++;
+  }
+  int64_t v = 0;
+  uint8_t digits = 0;
+  uint8_t fractionDigits = 0;
+  boolean fraction = false;
+  boolean roundUp = false;
+  for (; *s != '\0' && !isspace(*s); s++) {
+    if (*s == '.' && !fraction) {
+      fraction = true;
+    } else if (!isdigit(*s)) {
+      return false;
+    } else if (fraction && fractionDigits >= decimals) {
+      // the first surplus digit decides the rounding, the others are ignored:
+      if (fractionDigits++ == decimals) {
+        roundUp = *s >= '5';
+      }
+    } else {
+      v = v * 10 + (*s - '0');
+      if (fraction) {
+        fractionDigits++;
+      }
+      if (v > INT32_MAX) {
+        return false;
+      }
+    }
+    digits++;
+  }
+  if (digits == 0) {
+    return false;
+  }
+  for (; fractionDigits < decimals; fractionDigits++) {
+    v *= 10;
+  }
+  if (roundUp) {
+    v++;
+  }
+  if (negative) {
+    v = -v;
+  }
+  if (v < min || v > max) {
+    return false;
+  }
+  value = v;
+  return true;
+}
@@ -0,0 +1,43 @@
+#ifndef BC_FIXED_H_INCLUDED
+  #define BC_FIXED_H_INCLUDED
+
+  #include <BC_Control.h>
+
+  /*
+   * Scaled-integer (fixed-point) arithmetic for the energy and time-to-go math, so that neither soft-float nor
+   * dtostrf/atof are needed on MCUs without an FPU. The float config params are only read (and range checked)
+   * through the accessors below.
+   */
+  #define WATER_HEAT_CAPACITY 4186L   // [mJ / (ml * K)]
+  #define MAX_TANK_CAPACITY 1000000L  // [ml]
+  #define MAX_HEATER_POWER   100000L  // [W]
+
+  /*
+   * The config's tankCapacity [ml] and heaterPower [W], clamped to [0, MAX_...].
+   */
+  uint32_t tankCapacityMl(ConfigParams *config);
+  uint32_t heaterPowerW(ConfigParams *config);
+
+  /*
+   * Energy [J] needed to change the temperature of capacity [ml] water by delta [°C * 100] (negative for cooling).
+   */
+  int32_t heatingEnergy(uint32_t capacity, int32_t delta);
+
+  /*
+   * Time [s] the heater needs to bring the water from its current to the target temperature, 0 if it is already
+   * there, UNDEFINED_TIME_SECONDS if the water temperature or the heater power is not known.
+   */
+  TimeSeconds originalTimeToGo(ExecutionContext *context);
+
+  /*
+   * Formats value / 10^decimals, e.g. formatFixed(-1234, 2, buf) -> "-12.34". buf needs 13 chars.
+   */
+  char *formatFixed(int32_t value, uint8_t decimals, char buf[]);
+
+  /*
+   * Parses a decimal number (optional sign, optional fraction) into value * 10^decimals, rounding surplus fraction
+   * digits. Returns false if s is not a number or the result is outside [min, max].
+   */
+  boolean parseFixed(const char *s, uint8_t decimals, int32_t min, int32_t max, int32_t &value);
+
+#endif
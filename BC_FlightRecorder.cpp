@@ -0,0 +1,75 @@
+#include "BC_FlightRecorder.h"
+
+void FlightRecorder::writeRing(uint8_t pos, const FlightSample &sample) {
+  #ifdef FLIGHT_RECORDER_RING_IN_FRAM
+    store->writeBytes(FLIGHT_RECORDER_SNAPSHOT_SIZE + pos * sizeof(FlightSample), (const uint8_t *) &sample, sizeof(FlightSample));
+  #else
+    samples[pos] = sample;
+  #endif
+}
+
+void FlightRecorder::readRing(uint8_t pos, FlightSample samples[], uint8_t n) {
+  #ifdef FLIGHT_RECORDER_RING_IN_FRAM
+    store->readBytes(FLIGHT_RECORDER_SNAPSHOT_SIZE + pos * sizeof(FlightSample), (uint8_t *) samples, n * sizeof(FlightSample));
+  #else
+    memcpy(samples, &this->samples[pos], n * sizeof(FlightSample));
+  #endif
+}
+
+void FlightRecorder::record(TimeMillis now, const DS18B20_Sensor *water, const DS18B20_Sensor *ambient, boolean heaterOn, uint8_t state) {
+  FlightSample s;
+  s.time = now / 1000L;
+  s.water = water->currentTemp;
+  s.ambient = ambient->currentTemp;
+  s.flags = (water->sensorStatus & 0x7) | ((ambient->sensorStatus & 0x7) << 3) | (heaterOn ? FLIGHT_SAMPLE_HEATER_ON : 0);
+  s.state = state;
+  writeRing(next, s);
+  next = (next + 1) % FLIGHT_RECORDER_SAMPLES;
+  if (count < FLIGHT_RECORDER_SAMPLES) {
+    count++;
+  }
+  recorded++;
+
+  if (water->sensorStatus == DS18B20_SENSOR_NOK && lastWaterStatus != DS18B20_SENSOR_NOK) {
+    freeze(FAULT_WATER_SENSOR_NOK, now);
+  } else if (ambient->sensorStatus == DS18B20_SENSOR_NOK && lastAmbientStatus != DS18B20_SENSOR_NOK) {
+    freeze(FAULT_AMBIENT_SENSOR_NOK, now);
+  }
+  lastWaterStatus = water->sensorStatus;
+  lastAmbientStatus = ambient->sensorStatus;
+}
+
+void FlightRecorder::freeze(T_Fault_ID fault, TimeMillis now) {
+  // invalidate the previous snapshot first, then write the header last => an interrupted freeze leaves no valid snapshot:
+  FlightSnapshotHeader header;
+  memset(&header, 0, sizeof(FlightSnapshotHeader));
+  store->writeBytes(0, (const uint8_t *) &header, sizeof(FlightSnapshotHeader));
+  
+  // samples in chronological order, i.e. the ring unrolled:
+  uint8_t pos = (next + FLIGHT_RECORDER_SAMPLES - count) % FLIGHT_RECORDER_SAMPLES;
+  uint16_t offset = sizeof(FlightSnapshotHeader);
+  for (uint8_t copied = 0; copied < count; ) {
+    FlightSample buf[FLIGHT_RECORDER_COPY_SAMPLES];
+    uint8_t n = min((uint8_t) (FLIGHT_RECORDER_SAMPLES - pos), (uint8_t) (count - copied));
+    n = min(n, (uint8_t) FLIGHT_RECORDER_COPY_SAMPLES);
+    readRing(pos, buf, n);
+    store->writeBytes(offset, (const uint8_t *) buf, n * sizeof(FlightSample));
+    offset += n * sizeof(FlightSample);
+    pos = (pos + n) % FLIGHT_RECORDER_SAMPLES;
+    copied += n;
+  }
+  header.magic = FLIGHT_RECORDER_MAGIC;
+  header.fault = fault;
+  header.count = count;
+  header.time = now;
+  store->writeBytes(0, (const uint8_t *) &header, sizeof(FlightSnapshotHeader));
+}
+
+boolean FlightRecorder::readSnapshotHeader(FlightSnapshotHeader &header) {
+  store->readBytes(0, (uint8_t *) &header, sizeof(FlightSnapshotHeader));
+  return header.magic == FLIGHT_RECORDER_MAGIC && header.count <= FLIGHT_RECORDER_SAMPLES;
+}
+
+void FlightRecorder::readSnapshotSample(uint8_t i, FlightSample &sample) {
+  store->readBytes(sizeof(FlightSnapshotHeader) + i * sizeof(FlightSample), (uint8_t *) &sample, sizeof(FlightSample));
+}
@@ -0,0 +1,105 @@
+#ifndef BC_FLIGHT_RECORDER_H_INCLUDED
+  #define BC_FLIGHT_RECORDER_H_INCLUDED
+
+  #include <ACF_FRAM.h>
+  #include <ACF_DS18B20.h>
+
+  #define FLIGHT_RECORDER_SAMPLES  64  // sensor cycles kept (64 => 5+ minutes at 5 s per cycle)
+  #define FLIGHT_RECORDER_MAGIC    0xB1C8
+  #define FLIGHT_RECORDER_COPY_SAMPLES 8 // samples copied at a time when the ring is frozen
+
+  #if defined(__AVR__)
+    // the SRAM is too small for the ring, it is kept in FRAM behind the snapshot:
+    #define FLIGHT_RECORDER_RING_IN_FRAM
+  #endif
+
+  typedef enum {
+    FAULT_NONE = 0,
+    FAULT_WATER_SENSOR_NOK = 1,
+    FAULT_AMBIENT_SENSOR_NOK = 2,
+    FAULT_HEATER_CUT_OUT = 3
+  } FaultEnum;
+
+  typedef uint8_t T_Fault_ID;
+
+  /*
+   * One sensor cycle (8 bytes).
+   */
+  struct FlightSample {
+    // [s] since boot (wraps after 18 hours):
+    uint16_t time;
+    ACF_Temperature water;
+    ACF_Temperature ambient;
+    // bits 0..2: water sensor status, bits 3..5: ambient sensor status, bit 7: heater pin
+    uint8_t flags;
+    // low byte of the state ID:
+    uint8_t state;
+  } __attribute__((packed));
+
+  #define FLIGHT_SAMPLE_HEATER_ON 0x80
+
+  struct FlightSnapshotHeader {
+    uint16_t magic;
+    T_Fault_ID fault;
+    // number of valid samples in the snapshot, oldest first:
+    uint8_t count;
+    // [ms] since boot when the snapshot was taken:
+    TimeMillis time;
+  } __attribute__((packed));
+
+  #define FLIGHT_RECORDER_SNAPSHOT_SIZE (sizeof(FlightSnapshotHeader) + FLIGHT_RECORDER_SAMPLES * sizeof(FlightSample))
+  #ifdef FLIGHT_RECORDER_RING_IN_FRAM
+    #define FLIGHT_RECORDER_STORE_SIZE (FLIGHT_RECORDER_SNAPSHOT_SIZE + FLIGHT_RECORDER_SAMPLES * sizeof(FlightSample))
+  #else
+    #define FLIGHT_RECORDER_STORE_SIZE FLIGHT_RECORDER_SNAPSHOT_SIZE
+  #endif
+
+  /*
+   * Records every sensor cycle in a ring (in RAM, or in FRAM with FLIGHT_RECORDER_RING_IN_FRAM). On a fault (sensor 
+   * turning NOK, heater cut-out), the ring is frozen into the FRAM snapshot, where it survives resets until the next
+   * fault overwrites it.
+   */
+  class FlightRecorder {
+    public:
+      FlightRecorder(FRAMStore *store) {
+        this->store = store;
+      }
+
+      /*
+       * Records one sensor cycle; freezes a snapshot if a sensor has turned NOK since the previous cycle.
+       */
+      void record(TimeMillis now, const DS18B20_Sensor *water, const DS18B20_Sensor *ambient, boolean heaterOn, uint8_t state);
+
+      /*
+       * Freezes the current ring into FRAM.
+       */
+      void freeze(T_Fault_ID fault, TimeMillis now);
+
+      /*
+       * Reads the header of the FRAM snapshot. Returns false if there is no snapshot.
+       */
+      boolean readSnapshotHeader(FlightSnapshotHeader &header);
+
+      /*
+       * Reads sample i (0 = oldest) of the FRAM snapshot.
+       */
+      void readSnapshotSample(uint8_t i, FlightSample &sample);
+
+      // number of samples recorded since boot:
+      uint32_t recorded = 0L;
+
+    protected:
+      FRAMStore *store;
+      #ifndef FLIGHT_RECORDER_RING_IN_FRAM
+        FlightSample samples[FLIGHT_RECORDER_SAMPLES];
+      #endif
+      uint8_t next = 0;
+      uint8_t count = 0;
+      DS18B20_StatusID lastWaterStatus = DS18B20_SENSOR_INITIALISING;
+      DS18B20_StatusID lastAmbientStatus = DS18B20_SENSOR_INITIALISING;
+
+      void writeRing(uint8_t pos, const FlightSample &sample);
+      void readRing(uint8_t pos, FlightSample samples[], uint8_t n);
+  };
+
+#endif
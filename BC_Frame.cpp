@@ -0,0 +1,56 @@
+#include "BC_Frame.h"
+
+uint16_t frameCRC(uint8_t type, const void *payload, uint8_t length) {
+  uint8_t header[2] = { type, length };
+  return crc16((const uint8_t *) payload, length, crc16(header, sizeof(header)));
+}
+
+boolean FrameDecoder::feed(uint8_t b, TimeMillis now) {
+  if (state != WAIT_SYNC && now - lastByte > FRAME_BYTE_TIMEOUT) {
+    error = FRAME_ERROR_TIMEOUT;
+    state = WAIT_SYNC;
+  }
+  lastByte = now;
+
+  switch (state) {
+    case WAIT_SYNC:
+      if (b == FRAME_SYNC) {
+        state = WAIT_TYPE;
+      }
+      return false;
+    case WAIT_TYPE:
+      type = b;
+      state = WAIT_LENGTH;
+      return false;
+    case WAIT_LENGTH:
+      if (b > FRAME_MAX_REQUEST_PAYLOAD) {
+        error = FRAME_ERROR_LENGTH;
+        state = WAIT_SYNC;
+        return false;
+      }
+      length = b;
+      received = 0;
+      state = length > 0 ? WAIT_PAYLOAD : WAIT_CRC_LOW;
+      return false;
+    case WAIT_PAYLOAD:
+      payload[received++] = b;
+      if (received == length) {
+        state = WAIT_CRC_LOW;
+      }
+      return false;
+    case WAIT_CRC_LOW:
+      crc = b;
+      state = WAIT_CRC_HIGH;
+      return false;
+    case WAIT_CRC_HIGH:
+      crc |= (uint16_t) b << 8;
+      state = WAIT_SYNC;
+      if (crc != frameCRC(type, payload, length)) {
+        error = FRAME_ERROR_CRC;
+        return false;
+      }
+      error = FRAME_ERROR_NONE;
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,99 @@
+#ifndef BC_FRAME_H_INCLUDED
+  #define BC_FRAME_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include <BC_State.h>
+  #include "BC_Persistent.h"
+
+  /*
+   * Binary frames of the console's machine mode:
+   *
+   *   SYNC (0xA5) | type (1 byte) | length (1 byte) | payload (length bytes) | CRC-16 (2 bytes, little endian)
+   *
+   * The CRC (see crc16()) covers type, length and payload. Multi-byte values are little endian (native byte order).
+   */
+  #define FRAME_SYNC 0xA5
+  #define FRAME_OVERHEAD 5                 // [bytes] sync, type, length, CRC
+  #define FRAME_MAX_REQUEST_PAYLOAD 16     // [bytes] longest payload accepted from the host
+  #define FRAME_BYTE_TIMEOUT 100L          // [ms] a partially received frame is discarded after this time
+
+  enum FrameType : uint8_t {
+    // host -> controller:
+    FRAME_REQUEST = 0x01,      // MachineRequest
+    FRAME_EXIT = 0x7F,         // back to text mode (no payload)
+    // controller -> host:
+    FRAME_ACK = 0x81,          // uint8_t: 1 = command ok, 0 = command failed
+    FRAME_STATUS = 0x82,       // MachineStatus
+    FRAME_LOG_ENTRY = 0x83,    // log record, see BC_LogRecord.h
+    FRAME_END = 0x84,          // uint16_t: number of frames in the preceding response
+    FRAME_CONFIG = 0x85,       // ConfigBatchItem[]
+    FRAME_ERROR = 0x8F         // FrameError
+  };
+
+  enum FrameError : uint8_t {
+    FRAME_ERROR_NONE = 0,
+    FRAME_ERROR_LENGTH,
+    FRAME_ERROR_CRC,
+    FRAME_ERROR_TIMEOUT,
+    FRAME_ERROR_TYPE,
+    FRAME_ERROR_REQUEST        // MachineRequest with an unknown command or an illegal param or value
+  };
+
+  /*
+   * Payload of FRAME_REQUEST, the fields of the UserRequest. For CMD_INFO_LOG, param is the LogDataType to return
+   * (0xFF -> all types) and intValue the number of entries.
+   */
+  struct MachineRequest {
+    T_UserCommand_ID command;
+    uint8_t param;
+    int32_t intValue;
+    float floatValue;
+  } __attribute__((packed));
+
+  /*
+   * Payload of FRAME_STATUS, the fields of the StatusNotification.
+   */
+  struct MachineStatus {
+    uint16_t notifyProperties;
+    T_State_ID state;
+    UserCommands acceptedUserCommands;
+    int32_t timeInState;
+    int32_t heatingTime;
+    int32_t timeToGo;
+    uint8_t waterSensorStatus;
+    ACF_Temperature waterTemp;
+    uint8_t ambientSensorStatus;
+    ACF_Temperature ambientTemp;
+  } __attribute__((packed));
+
+  /*
+   * Incremental decoder of the frames received from the host; feed it every received byte.
+   */
+  class FrameDecoder {
+    public:
+      FrameDecoder() {}
+
+      /*
+       * Returns true when a complete frame with a valid CRC has been received (type, length and payload are then
+       * valid until the next call). On a malformed frame, error is set and the decoder resynchronizes on the next SYNC.
+       */
+      boolean feed(uint8_t b, TimeMillis now);
+
+      uint8_t type = 0;
+      uint8_t length = 0;
+      uint8_t payload[FRAME_MAX_REQUEST_PAYLOAD];
+      FrameError error = FRAME_ERROR_NONE;
+
+    protected:
+      enum { WAIT_SYNC, WAIT_TYPE, WAIT_LENGTH, WAIT_PAYLOAD, WAIT_CRC_LOW, WAIT_CRC_HIGH } state = WAIT_SYNC;
+      uint8_t received = 0;
+      uint16_t crc = 0;
+      TimeMillis lastByte = 0L;
+  };
+
+  /*
+   * CRC of a frame as sent after its payload.
+   */
+  uint16_t frameCRC(uint8_t type, const void *payload, uint8_t length);
+
+#endif
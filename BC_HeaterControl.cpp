@@ -0,0 +1,127 @@
+#include "BC_HeaterControl.h"
+#include "BC_Fixed.h"
+
+// #define DEBUG_HEATER_CONTROL
+
+#define MAX_DUTY 1000              // [‰]
+
+void HeaterControl::init(ExecutionContext *context) {
+  this->context = context;
+  persistent.load(params);
+}
+
+boolean HeaterControl::setParam(uint8_t id, int32_t value) {
+  switch(id) {
+    case HEATER_CONTROL_PARAM_MODE:
+      if (value != HEATER_CONTROL_THRESHOLD && value != HEATER_CONTROL_TIME_PROPORTIONAL) {
+        return false;
+      }
+      params.mode = value;
+      break;
+    case HEATER_CONTROL_PARAM_WINDOW:
+      if (value < MIN_HEATER_CONTROL_WINDOW || value > MAX_HEATER_CONTROL_WINDOW) {
+        return false;
+      }
+      params.windowSeconds = value;
+      break;
+    case HEATER_CONTROL_PARAM_KP:
+      if (value < 0 || value > MAX_HEATER_CONTROL_GAIN) {
+        return false;
+      }
+      params.kp = value;
+      break;
+    case HEATER_CONTROL_PARAM_KI:
+      if (value < 0 || value > MAX_HEATER_CONTROL_GAIN) {
+        return false;
+      }
+      params.ki = value;
+      break;
+    default:
+      return false;
+  }
+  persistent.save(params);
+  return true;
+}
+
+int32_t HeaterControl::getParam(uint8_t id) {
+  switch(id) {
+    case HEATER_CONTROL_PARAM_MODE:   return params.mode;
+    case HEATER_CONTROL_PARAM_WINDOW: return params.windowSeconds;
+    case HEATER_CONTROL_PARAM_KP:     return params.kp;
+    case HEATER_CONTROL_PARAM_KI:     return params.ki;
+    default: return 0L;
+  }
+}
+
+void HeaterControl::update(TimeMillis now, boolean heating) {
+  // the automaton's actions drive the heater pin, too => the on-time is measured at the pin:
+  if (digitalRead(HEATER_PIN) == HIGH) {
+    onMillis += now - lastUpdate;
+  }
+  lastUpdate = now;
+
+  if (! heating || ! isTimeProportional() || context->op->water.sensorStatus != DS18B20_SENSOR_OK) {
+    if (active && heating && ! isTimeProportional()) {
+      // mode changed while heating => hand the heater back to the automaton:
+      setHeater(true);
+    } else if (heating && isTimeProportional()) {
+      // no valid water temperature => no heating until the automaton has handled the sensor failure:
+      setHeater(false);
+    }
+    // the automaton's actions own the heater pin:
+    active = false;
+    return;
+  }
+
+  TimeMillis window = params.windowSeconds * 1000L;
+  if (! active || now - windowStart >= window) {
+    ACF_Temperature error = context->config->targetTemp - context->op->water.currentTemp;
+    if (active) {
+      integral += (int32_t) error * params.windowSeconds;
+    } else {
+      integral = 0L;
+    }
+    active = true;
+    windowStart = now;
+    duty = computeDuty(error);
+    #ifdef DEBUG_HEATER_CONTROL
+      Serial.print(F("DEBUG_HEATER_CONTROL: error: "));
+      Serial.print(error);
+      Serial.print(F(", duty: "));
+      Serial.println(duty);
+    #endif
+  }
+
+  setHeater(now - windowStart < (TimeMillis) duty * window / MAX_DUTY);
+}
+
+int16_t HeaterControl::computeDuty(ACF_Temperature error) {
+  // energy to close the gap within the horizon relative to the energy the heater delivers within it:
+  int32_t feedForward = 0L;
+  uint32_t power = heaterPowerW(context->config);
+  if (power > 0) {
+    feedForward = (int64_t) MAX_DUTY * heatingEnergy(tankCapacityMl(context->config), error)
+                  / ((int64_t) power * HEATER_CONTROL_FF_HORIZON);
+  }
+  int32_t proportional = (int32_t) params.kp * error / 100L;
+  int32_t integralTerm = (int32_t) params.ki * integral / (100L * 60L);
+
+  // anti-windup: stop integrating beyond the output limits
+  if (integralTerm > MAX_DUTY) {
+    integral = (int32_t) MAX_DUTY * 100L * 60L / max(params.ki, (int16_t) 1);
+    integralTerm = MAX_DUTY;
+  } else if (integralTerm < -MAX_DUTY) {
+    integral = - (int32_t) MAX_DUTY * 100L * 60L / max(params.ki, (int16_t) 1);
+    integralTerm = -MAX_DUTY;
+  }
+  int32_t d = (feedForward > MAX_DUTY ? MAX_DUTY : feedForward) + proportional + integralTerm;
+  return constrain(d, (int32_t) 0, (int32_t) MAX_DUTY);
+}
+
+void HeaterControl::setHeater(boolean on) {
+  uint8_t level = on ? HIGH : LOW;
+  if (digitalRead(HEATER_PIN) != level) {
+    digitalWrite(HEATER_PIN, level);
+    switches++;
+  }
+}
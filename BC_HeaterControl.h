@@ -0,0 +1,89 @@
+#ifndef BC_HEATER_CONTROL_H_INCLUDED
+  #define BC_HEATER_CONTROL_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include "BC_Persistent.h"
+
+  typedef enum {
+    HEATER_CONTROL_THRESHOLD = 0,        // heater is on for the whole HEATING state (automaton thresholds only)
+    HEATER_CONTROL_TIME_PROPORTIONAL = 1 // heater is pulsed within a slow PWM window while HEATING
+  } HeaterControlMode;
+
+  /*
+   * Parameters of the heater control; they extend the ConfigParams and are numbered after them.
+   */
+  typedef enum {
+    HEATER_CONTROL_PARAM_MODE = 0,
+    HEATER_CONTROL_PARAM_WINDOW = 1,
+    HEATER_CONTROL_PARAM_KP = 2,
+    HEATER_CONTROL_PARAM_KI = 3
+  } HeaterControlParamEnum;
+
+  #define NUM_HEATER_CONTROL_PARAMS 4
+  #define HEATER_CONTROL_PARAM_BASE_ID (NUM_CONFIG_PARAMS + 1)
+
+  #define DEFAULT_HEATER_CONTROL_WINDOW  60 // [s]
+  #define DEFAULT_HEATER_CONTROL_KP     200 // [‰ / °C]
+  #define DEFAULT_HEATER_CONTROL_KI      20 // [‰ / (°C * min)]
+  #define MIN_HEATER_CONTROL_WINDOW      10 // [s] protects the relay
+  #define MAX_HEATER_CONTROL_WINDOW     600 // [s]
+  #define MAX_HEATER_CONTROL_GAIN      1000
+  #define HEATER_CONTROL_FF_HORIZON    1800 // [s] time within which the feed-forward term closes the temperature gap
+
+  struct HeaterControlParams {
+    uint8_t mode = HEATER_CONTROL_THRESHOLD;
+    uint16_t windowSeconds = DEFAULT_HEATER_CONTROL_WINDOW;
+    int16_t kp = DEFAULT_HEATER_CONTROL_KP;
+    int16_t ki = DEFAULT_HEATER_CONTROL_KI;
+  };
+
+  /*
+   * Time-proportioning PI controller with feed-forward: once per window, the duty cycle [‰] is computed from
+   *   - the energy needed to bring the tank to the target temperature within HEATER_CONTROL_FF_HORIZON (tankCapacity,
+   *     heaterPower), i.e. the feed-forward share shrinks with the gap instead of saturating for any gap that
+   *     can't be closed within one window,
+   *   - the proportional and integral terms of the temperature error.
+   * The heater is then on for the first duty * window of the window. The automaton's cut-out thresholds stay in force.
+   */
+  class HeaterControl {
+    public:
+      HeaterControl(FRAMStore *store) : persistent(PersistentBlock<HeaterControlParams>(store)) { }
+
+      void init(ExecutionContext *context);
+
+      /*
+       * Call from every loop iteration; heating is true while the automaton is in state HEATING.
+       */
+      void update(TimeMillis now, boolean heating);
+
+      boolean isTimeProportional() { return params.mode == HEATER_CONTROL_TIME_PROPORTIONAL; }
+
+      /*
+       * Id is the index of a HeaterControlParamEnum literal. Returns false if the value is out of range.
+       */
+      boolean setParam(uint8_t id, int32_t value);
+      int32_t getParam(uint8_t id);
+
+      HeaterControlParams params;
+
+      // duty cycle [‰] of the current window:
+      int16_t duty = 0;
+      // number of relay switches performed by this control since boot:
+      uint32_t switches = 0L;
+      // [ms] heater on-time since boot, in either mode:
+      uint32_t onMillis = 0L;
+
+    protected:
+      PersistentBlock<HeaterControlParams> persistent;
+      ExecutionContext *context = NULL;
+      boolean active = false;
+      TimeMillis windowStart = 0L;
+      TimeMillis lastUpdate = 0L;
+      // accumulated error [°C * 100 * s]:
+      int32_t integral = 0L;
+
+      int16_t computeDuty(ACF_Temperature error);
+      void setHeater(boolean on);
+  };
+
+#endif
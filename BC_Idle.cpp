@@ -0,0 +1,20 @@
+#include "BC_Idle.h"
+
+#if defined(__AVR__)
+  #include <avr/sleep.h>
+#endif
+
+void idleSleep() {
+  #if defined(__AVR__)
+    // wakes up on the next timer-0 overflow (millis), USART RX or external interrupt:
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+  #elif defined(__arm__)
+    // wakes up on the next SysTick (millis) or any other enabled interrupt:
+    __WFI();
+  #else
+    delay(1);
+  #endif
+}
@@ -0,0 +1,12 @@
+#ifndef BC_IDLE_H_INCLUDED
+  #define BC_IDLE_H_INCLUDED
+
+  #include <ACF_Types.h>
+
+  /*
+   * Puts the MCU into its idle sleep state until the next interrupt (system tick, serial RX, pin change, ...).
+   * Peripherals and millis() keep running.
+   */
+  void idleSleep();
+
+#endif
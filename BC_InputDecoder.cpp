@@ -0,0 +1,152 @@
+#include "BC_InputDecoder.h"
+#include "BC_Fixed.h"
+#include "BC_HeaterControl.h"
+
+boolean isUserCommand(int32_t cmd) {
+  // the commands are single bits, see UserCommands:
+  return cmd > CMD_NONE && cmd <= CMD_HEAT_RESET && (cmd & (cmd - 1)) == 0;
+}
+
+boolean decodeUserCommand(const uint8_t data[], uint16_t len, uint16_t maxLen, UserCommandEnum &cmd) {
+  if (len < sizeof(T_UserCommand_ID) || len > maxLen) {
+    return false;
+  }
+  T_UserCommand_ID id;
+  memcpy(&id, data, sizeof(T_UserCommand_ID));
+  if (! isUserCommand(id)) {
+    return false;
+  }
+  cmd = UserCommandEnum(id);
+  return true;
+}
+
+boolean decodeTargetTemp(const uint8_t data[], uint16_t len, ACF_Temperature &temp) {
+  if (len != sizeof(ACF_Temperature)) {
+    return false;
+  }
+  ACF_Temperature t;
+  memcpy(&t, data, sizeof(ACF_Temperature));
+  if (! configValueInRange((uint8_t) ConfigParam::TARGET_TEMP, t)) {
+    return false;
+  }
+  temp = t;
+  return true;
+}
+
+boolean decodeRollupSelection(const uint8_t data[], uint16_t len, RollupPeriod &period, uint16_t &age) {
+  if (len != 1 + sizeof(uint16_t) || (data[0] != ROLLUP_HOUR && data[0] != ROLLUP_DAY)) {
+    return false;
+  }
+  period = RollupPeriod(data[0]);
+  memcpy(&age, &data[1], sizeof(uint16_t));
+  return true;
+}
+
+boolean decodeFlightRecorderSelection(const uint8_t data[], uint16_t len, uint16_t &index) {
+  if (len != sizeof(uint16_t)) {
+    return false;
+  }
+  memcpy(&index, data, sizeof(uint16_t));
+  return true;
+}
+
+int8_t decodeConfigBatchFragment(const uint8_t data[], uint16_t len, uint8_t maxItems, uint8_t &flags, ConfigBatchItem items[]) {
+  if (len < 1 || (len - 1) % sizeof(ConfigBatchItem) != 0 || (len - 1) / sizeof(ConfigBatchItem) > maxItems) {
+    return -1;
+  }
+  flags = data[0];
+  int8_t count = (len - 1) / sizeof(ConfigBatchItem);
+  memcpy(items, &data[1], count * sizeof(ConfigBatchItem));
+  return count;
+}
+
+boolean checkMachineRequest(const MachineRequest &r) {
+  if (! isUserCommand(r.command)) {
+    return false;
+  }
+  if (r.command == CMD_INFO_LOG) {
+    return (r.param <= (uint8_t) LogDataType::CONFIG || r.param == 0xFF) && r.intValue >= -1L && r.intValue <= UINT16_MAX;
+  }
+  if (r.command != CMD_CONFIG_SET_VALUE) {
+    return true;
+  }
+  if (r.param >= HEATER_CONTROL_PARAM_BASE_ID && r.param < HEATER_CONTROL_PARAM_BASE_ID + NUM_HEATER_CONTROL_PARAMS) {
+    return true;
+  }
+  ConfigParam param = ConfigParam(r.param);
+  if (param != ConfigParam::TANK_CAPACITY && param != ConfigParam::HEATER_POWER) {
+    return configValueInRange(r.param, r.intValue);
+  }
+  // NaN fails both comparisons:
+  float max = param == ConfigParam::TANK_CAPACITY ? MAX_TANK_CAPACITY : MAX_HEATER_POWER;
+  if (!(r.floatValue > -1.0f && r.floatValue < max + 1.0f)) {
+    return false;
+  }
+  int32_t value = (int32_t) r.floatValue;
+  return value == r.floatValue && configValueInRange(r.param, value);
+}
+
+uint8_t normalizeCommandLine(char buf[], uint8_t count) {
+  uint8_t len = 0;
+  boolean prevSpace = false;
+  for (uint8_t i = 0; i < count && buf[i] != '\0'; i++) {
+    boolean space = isspace(buf[i]);
+    if (! (space && prevSpace)) {
+      buf[len++] = space ? ' ' : tolower(buf[i]);
+    }
+    prevSpace = space;
+  }
+  if (len > 0 && buf[len - 1] == ' ') {
+    len--;
+  }
+  buf[len] = '\0';
+  return len;
+}
+
+uint8_t splitCommandLine(char line[], const char cmdChars[], char **args) {
+  uint8_t cmdLen = strspn(line, cmdChars);
+  *args = &line[cmdLen];
+  if (cmdLen > 0 && line[cmdLen - 1] == ' ') {
+    // the blank separating the args terminates the command:
+    cmdLen--;
+    line[cmdLen] = '\0';
+  } else if (line[cmdLen] != '\0') {
+    // args not separated from the command (e.g. 'log5'):
+    return 0;
+  }
+  return cmdLen;
+}
+
+boolean parseIntArg(char *s, int32_t min, int32_t max, int32_t &value, char **next) {
+  boolean negative = *s == '-';
+  if (*s == '-' || *s == '+') {
+    s++;
+  }
+  int64_t v = 0;
+  uint8_t digits = 0;
+  for (; *s != '\0' && *s != ' '; s++) {
+    // a fraction or any other char rejects the whole arg:
+    if (!isdigit(*s)) {
+      return false;
+    }
+    v = v * 10 + (*s - '0');
+    if (v > (int64_t) INT32_MAX + 1) {
+      return false;
+    }
+    digits++;
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (negative) {
+    v = -v;
+  }
+  if (v < min || v > max) {
+    return false;
+  }
+  value = v;
+  if (next != NULL) {
+    *next = *s == ' ' ? s + 1 : s;
+  }
+  return true;
+}
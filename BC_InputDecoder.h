@@ -0,0 +1,75 @@
+#ifndef BC_INPUT_DECODER_H_INCLUDED
+  #define BC_INPUT_DECODER_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include "BC_ConfigBatch.h"
+  #include "BC_Rollup.h"
+  #include "BC_Frame.h"
+
+  /*
+   * Decoders of the raw input received by the UIs (GATT writes, console lines). They depend on nothing but their
+   * arguments, i.e. neither on the BLE module nor on Serial, and reject malformed input as a whole: nothing is
+   * passed on unless the entire input has been validated.
+   */
+
+  /*
+   * True if cmd is exactly one of the known UserCommandEnum literals (CMD_NONE excluded).
+   */
+  boolean isUserCommand(int32_t cmd);
+
+  /*
+   * USER_REQUEST_CID: T_UserCommand_ID, optionally followed by up to USER_CMD_PARAMETER_MAX_SIZE bytes (ignored).
+   */
+  boolean decodeUserCommand(const uint8_t data[], uint16_t len, uint16_t maxLen, UserCommandEnum &cmd);
+
+  /*
+   * TARGET_TEMP_CID: ACF_Temperature [1/100 °C] within the range accepted for the target temperature.
+   */
+  boolean decodeTargetTemp(const uint8_t data[], uint16_t len, ACF_Temperature &temp);
+
+  /*
+   * ROLLUP_CID: { RollupPeriod (1 byte), age (2 bytes) }.
+   */
+  boolean decodeRollupSelection(const uint8_t data[], uint16_t len, RollupPeriod &period, uint16_t &age);
+
+  /*
+   * FLIGHT_RECORDER_CID: index of the first sample of the chunk (2 bytes).
+   */
+  boolean decodeFlightRecorderSelection(const uint8_t data[], uint16_t len, uint16_t &index);
+
+  /*
+   * CONFIG_BATCH_CID: { flags (1 byte), ConfigBatchItem[0..maxItems] }. Returns the number of items copied to items[],
+   * -1 if len is not 1 + a multiple of sizeof(ConfigBatchItem) or if there are more than maxItems.
+   */
+  int8_t decodeConfigBatchFragment(const uint8_t data[], uint16_t len, uint8_t maxItems, uint8_t &flags, ConfigBatchItem items[]);
+
+  /*
+   * Machine mode FRAME_REQUEST: the command must be known; CMD_CONFIG_SET_VALUE needs a config param with a value in
+   * range (configValueInRange(), the float params as whole numbers in floatValue) or a heater-control param (its
+   * value is checked by HeaterControl::setParam()); CMD_INFO_LOG needs a LogDataType or 0xFF and at most
+   * UINT16_MAX entries (-1 -> all).
+   */
+  boolean checkMachineRequest(const MachineRequest &r);
+
+  /*
+   * Normalises the first count chars of a console line in place: consecutive white space is collapsed, trailing white
+   * space (e.g. the line ending) is removed, letters are converted to lower case, the line is \0-terminated (buf must
+   * hold count + 1 chars). Returns the new length.
+   */
+  uint8_t normalizeCommandLine(char buf[], uint8_t count);
+
+  /*
+   * Splits a normalised console line into the command (the leading chars in cmdChars, without the trailing blank)
+   * and its arguments. The command is \0-terminated in place; returns its length, args points to the rest of the line.
+   * Returns 0 (line unchanged) if the line does not start with a command followed by a blank or the end of the line.
+   */
+  uint8_t splitCommandLine(char line[], const char cmdChars[], char **args);
+
+  /*
+   * Parses the integer at the start of s (terminated by \0 or a blank) if it is within [min, max]; fractions and any
+   * other non-digit (apart from a leading sign) are rejected. On success,
+   * *next (if given) points to the next argument, i.e. past the following blank.
+   */
+  boolean parseIntArg(char *s, int32_t min, int32_t max, int32_t &value, char **next = NULL);
+
+#endif
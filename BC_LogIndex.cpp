@@ -0,0 +1,183 @@
+#include "BC_LogIndex.h"
+
+void LogTypeIndex::init() {
+  ASSERT(log->maxLogEntries() <= LOG_INDEX_RING_SIZE, "log index rings smaller than the log");
+  // entries logged before the reset and never notified are part of the rebuilt index:
+  LogEntry e;
+  log->readUnnotifiedLogEntries();
+  while (log->nextLogEntry(e)) { }
+
+  memset(&header, 0, sizeof(LogIndexHeader));
+  memset(stagedCount, 0, sizeof(stagedCount));
+  log->readMostRecentLogEntries(0);
+  while (log->nextLogEntry(e)) {
+    appendSeq(ringIndex(LogDataType(e.type)));
+  }
+  flush();
+}
+
+int8_t LogTypeIndex::ringIndex(LogDataType type) {
+  switch(type) {
+    case LogDataType::MESSAGE: return 0;
+    case LogDataType::STATE:   return 1;
+    case LogDataType::CONFIG:  return 2;
+    default: return -1;
+  }
+}
+
+boolean LogTypeIndex::isIndexed(LogDataType type) {
+  return ringIndex(type) >= 0;
+}
+
+uint16_t LogTypeIndex::seqOffset(uint8_t ring, uint16_t pos) {
+  return (ring * LOG_INDEX_RING_SIZE + pos % LOG_INDEX_RING_SIZE) * sizeof(LogSeq);
+}
+
+LogSeq LogTypeIndex::readSeq(uint8_t ring, uint16_t pos) {
+  uint16_t stagedPos = pos - (header.count[ring] - stagedCount[ring]);
+  if (stagedPos < stagedCount[ring]) {
+    return staged[ring][stagedPos];
+  }
+  LogSeq seq;
+  store->readBytes(seqOffset(ring, pos), (uint8_t *) &seq, sizeof(LogSeq));
+  bytesRead += sizeof(LogSeq);
+  return seq;
+}
+
+void LogTypeIndex::appendSeq(int8_t ring) {
+  if (ring >= 0) {
+    if (stagedCount[ring] == LOG_INDEX_STAGE_SIZE) {
+      flush();
+    }
+    if (stagedTotal() == 0) {
+      firstStaged = millis();
+    }
+    staged[ring][stagedCount[ring]++] = header.logCount;
+    header.count[ring]++;
+  }
+  header.logCount++;
+}
+
+void LogTypeIndex::append(const LogEntry &entry) {
+  appendSeq(ringIndex(LogDataType(entry.type)));
+}
+
+uint8_t LogTypeIndex::stagedTotal() {
+  uint8_t n = 0;
+  for (uint8_t ring = 0; ring < NUM_INDEXED_LOG_TYPES; ring++) {
+    n += stagedCount[ring];
+  }
+  return n;
+}
+
+boolean LogTypeIndex::flushDue(TimeMillis now) {
+  return stagedTotal() > 0 && now - firstStaged >= LOG_INDEX_FLUSH_DEADLINE;
+}
+
+void LogTypeIndex::writeSeqs(uint8_t ring, uint16_t pos, const LogSeq seqs[], uint8_t n) {
+  store->writeBytes(seqOffset(ring, pos), (const uint8_t *) seqs, n * sizeof(LogSeq));
+  writes++;
+}
+
+void LogTypeIndex::flush() {
+  for (uint8_t ring = 0; ring < NUM_INDEXED_LOG_TYPES; ring++) {
+    uint8_t n = stagedCount[ring];
+    if (n == 0) {
+      continue;
+    }
+    uint16_t pos = header.count[ring] - n;
+    // one burst up to the end of the ring, the rest from its start:
+    uint8_t head = LOG_INDEX_RING_SIZE - pos % LOG_INDEX_RING_SIZE;
+    if (head > n) {
+      head = n;
+    }
+    writeSeqs(ring, pos, staged[ring], head);
+    if (head < n) {
+      writeSeqs(ring, pos + head, staged[ring] + head, n - head);
+    }
+    stagedCount[ring] = 0;
+  }
+}
+
+uint16_t LogTypeIndex::entriesInLog() {
+  uint16_t n = log->currentLogEntries();
+  return header.logCount < n ? header.logCount : n;
+}
+
+/*
+ * Number of the (at most max) most recent entries of the ring that are still in the log.
+ */
+uint16_t LogTypeIndex::availableInLog(uint8_t ring, uint16_t max) {
+  if (max > header.count[ring]) {
+    max = header.count[ring];
+  }
+  if (max > LOG_INDEX_RING_SIZE) {
+    max = LOG_INDEX_RING_SIZE;
+  }
+  uint16_t inLog = entriesInLog();
+  uint16_t n = 0;
+  while (n < max && (LogSeq) (header.logCount - readSeq(ring, header.count[ring] - 1 - n)) <= inLog) {
+    n++;
+  }
+  return n;
+}
+
+void LogTypeIndex::readMostRecentEntries(LogDataType type, uint16_t n) {
+  readRing = ringIndex(type);
+  if (readRing < 0) {
+    return;
+  }
+  n = availableInLog(readRing, n == 0 ? UINT16_MAX : n);
+  readEnd = header.count[readRing];
+  readPos = readEnd - n;
+}
+
+boolean LogTypeIndex::nextEntry(LogEntry &entry) {
+  while (readRing >= 0 && readPos != readEnd) {
+    LogSeq seq = readSeq(readRing, readPos++);
+    log->readMostRecentLogEntries((LogSeq) (header.logCount - seq));
+    if (log->nextLogEntry(entry)) {
+      bytesRead += sizeof(LogEntry);
+      if (ringIndex(LogDataType(entry.type)) == readRing) {
+        return true;
+      }
+    }
+  }
+  readRing = -1;
+  return false;
+}
+
+uint16_t LogTypeIndex::valuesLogSpan(uint16_t n) {
+  uint16_t inLog = entriesInLog();
+  if (n == 0) {
+    return inLog;
+  }
+  // walk back through the log, newest first; the newest not yet passed entry of each ring tells the indexed 
+  // entries from the VALUES entries:
+  uint16_t passed[NUM_INDEXED_LOG_TYPES] = { 0 };
+  LogSeq next[NUM_INDEXED_LOG_TYPES];
+  for (uint8_t ring = 0; ring < NUM_INDEXED_LOG_TYPES; ring++) {
+    if (header.count[ring] > 0) {
+      next[ring] = readSeq(ring, header.count[ring] - 1);
+    }
+  }
+  uint16_t span = 0;
+  uint16_t values = 0;
+  while (values < n && span < inLog) {
+    LogSeq seq = header.logCount - 1 - span;
+    boolean indexed = false;
+    for (uint8_t ring = 0; ring < NUM_INDEXED_LOG_TYPES && !indexed; ring++) {
+      if (passed[ring] < header.count[ring] && passed[ring] < LOG_INDEX_RING_SIZE && next[ring] == seq) {
+        indexed = true;
+        if (++passed[ring] < header.count[ring] && passed[ring] < LOG_INDEX_RING_SIZE) {
+          next[ring] = readSeq(ring, header.count[ring] - 1 - passed[ring]);
+        }
+      }
+    }
+    if (!indexed) {
+      values++;
+    }
+    span++;
+  }
+  return span;
+}
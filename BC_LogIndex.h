@@ -0,0 +1,105 @@
+#ifndef BC_LOG_INDEX_H_INCLUDED
+  #define BC_LOG_INDEX_H_INCLUDED
+
+  #include <ACF_Logging.h>
+
+  #define LOG_STORE_SIZE      1024  // [bytes] FRAM of the log
+  // entries kept per indexed log-data type, at least the entries the log can hold => a ring never wraps within the log:
+  #define LOG_INDEX_RING_SIZE (LOG_STORE_SIZE / sizeof(LogEntry))
+  #define NUM_INDEXED_LOG_TYPES  3  // MESSAGE, STATE, CONFIG
+  #define LOG_INDEX_STAGE_SIZE   4  // sequence numbers per ring staged in RAM before they are written to FRAM
+  #define LOG_INDEX_FLUSH_DEADLINE 30000L // [ms] max. time a sequence number is staged
+
+  // sequence number of a log entry (entries appended to the log before it since the index was built; wraps):
+  typedef uint16_t LogSeq;
+
+  // counters of the index (in RAM only, they are rebuilt with the index):
+  struct LogIndexHeader {
+    // total number of entries appended to the log:
+    LogSeq logCount;
+    // total number of entries appended per indexed type; the ring position is count % LOG_INDEX_RING_SIZE:
+    uint16_t count[NUM_INDEXED_LOG_TYPES];
+  };
+
+  #define LOG_INDEX_STORE_SIZE (NUM_INDEXED_LOG_TYPES * LOG_INDEX_RING_SIZE * sizeof(LogSeq))
+
+  /*
+   * Per-type index of the log. VALUES entries make up the bulk of the log, so the positions of the sparse types
+   * (MESSAGE, STATE, CONFIG) are kept in rings of their own: filtered queries on them read only their own entries
+   * from the log. For VALUES queries, the rings tell how many of the most recent log entries must be read to cover
+   * the requested number of VALUES entries.
+   *
+   * The index is rebuilt from the log at init(), so it can't drift from it (e.g. by entries logged right before a
+   * reset, which are never delivered to the user notifications). After that, it is fed with every new log entry as
+   * delivered to the user notifications; queries must only be made when all log entries have been delivered.
+   *
+   * New sequence numbers are staged in RAM (where queries see them right away) and written to the FRAM rings in one
+   * burst per ring when a stage is full or, while the controller has nothing else to do, when the oldest staged
+   * one is LOG_INDEX_FLUSH_DEADLINE old. Nothing is lost on a reset, the index is rebuilt anyway.
+   */
+  class LogTypeIndex {
+    public:
+      LogTypeIndex(FRAMStore *store, Log *log) {
+        this->store = store;
+        this->log = log;
+      }
+
+      /*
+       * Rebuilds the index from the entries in the log. The entries not yet notified are skipped, they are
+       * not delivered to the user notifications after the rebuild.
+       */
+      void init();
+
+      void append(const LogEntry &entry);
+
+      /*
+       * Returns true if the given type has its own ring (i.e. can be read by readMostRecentEntries).
+       */
+      static boolean isIndexed(LogDataType type);
+
+      /*
+       * Prepares reading the n most recent entries of an indexed type (0 -> all), oldest first.
+       */
+      void readMostRecentEntries(LogDataType type, uint16_t n);
+
+      boolean nextEntry(LogEntry &entry);
+
+      boolean flushDue(TimeMillis now);
+
+      /*
+       * Writes the staged sequence numbers to FRAM.
+       */
+      void flush();
+
+      /*
+       * Returns the number of most recent log entries that contain the n most recent VALUES entries (0 -> all).
+       */
+      uint16_t valuesLogSpan(uint16_t n);
+
+      // FRAM bytes read by queries since boot:
+      uint32_t bytesRead = 0L;
+      // FRAM write transactions of the index since boot:
+      uint32_t writes = 0L;
+
+    protected:
+      FRAMStore *store;
+      Log *log;
+      LogIndexHeader header;
+      LogSeq staged[NUM_INDEXED_LOG_TYPES][LOG_INDEX_STAGE_SIZE];
+      uint8_t stagedCount[NUM_INDEXED_LOG_TYPES];
+      TimeMillis firstStaged = 0L;
+      int8_t readRing = -1;
+      uint16_t readPos = 0;
+      uint16_t readEnd = 0;
+
+      static int8_t ringIndex(LogDataType type);
+      uint16_t seqOffset(uint8_t ring, uint16_t pos);
+      LogSeq readSeq(uint8_t ring, uint16_t pos);
+      void appendSeq(int8_t ring);
+      uint8_t stagedTotal();
+      void writeSeqs(uint8_t ring, uint16_t pos, const LogSeq seqs[], uint8_t n);
+      uint16_t entriesInLog();
+      uint16_t availableInLog(uint8_t ring, uint16_t max);
+  };
+
+#endif
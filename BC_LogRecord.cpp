@@ -0,0 +1,87 @@
+#include "BC_LogRecord.h"
+
+#ifdef LOG_RECORD_COMPACT
+static_assert(LOG_RECORD_STATE_SIZE <= LOG_RECORD_VALUES_SIZE && LOG_RECORD_STATE_SIZE <= LOG_RECORD_CONFIG_SIZE,
+  "LOG_RECORD_MIN_SIZE is not the smallest record");
+static_assert(LOG_RECORD_STATE_SIZE <= LOG_RECORD_MESSAGE_SIZE && LOG_RECORD_CONFIG_SIZE <= LOG_RECORD_MESSAGE_SIZE,
+  "LOG_RECORD_MAX_SIZE is not the largest record");
+#endif
+
+uint8_t logRecordSize(LogDataType type) {
+  switch (type) {
+    case LogDataType::MESSAGE: return LOG_RECORD_HEADER_SIZE + LOG_RECORD_MESSAGE_SIZE;
+    case LogDataType::VALUES:  return LOG_RECORD_HEADER_SIZE + LOG_RECORD_VALUES_SIZE;
+    case LogDataType::STATE:   return LOG_RECORD_HEADER_SIZE + LOG_RECORD_STATE_SIZE;
+    case LogDataType::CONFIG:  return LOG_RECORD_HEADER_SIZE + LOG_RECORD_CONFIG_SIZE;
+    default: return 0;
+  }
+}
+
+int32_t logConfigValue(const LogConfigParamData &data) {
+  return data.newValue * 100 + (data.newValue < 0 ? -0.5f : 0.5f);
+}
+
+#ifdef LOG_RECORD_COMPACT
+static uint8_t *put(uint8_t *p, const void *field, uint8_t size) {
+  memcpy(p, field, size);
+  return p + size;
+}
+#endif
+
+uint8_t encodeLogRecord(const LogEntry &e, uint8_t record[]) {
+  LogDataType type = LogDataType(e.type);
+  uint8_t size = logRecordSize(type);
+  if (size == 0) {
+    return 0;
+  }
+  #ifndef LOG_RECORD_COMPACT
+    memcpy(record, &e, sizeof(LogEntry));
+    return sizeof(LogEntry);
+  #else
+  uint8_t *p = record;
+  *p++ = (LOG_RECORD_VERSION << 4) | (e.type & 0x0F);
+  p = put(p, &e.timestamp, sizeof(e.timestamp));
+
+  // the LogData views are copied out of the entry, LogData need not be aligned for them:
+  switch (type) {
+    case LogDataType::MESSAGE:
+      {
+        LogMessageData data;
+        memcpy(&data, &e.data, sizeof(LogMessageData));
+        p = put(p, &data.id, sizeof(data.id));
+        p = put(p, data.params, sizeof(data.params));
+      }
+      break;
+    case LogDataType::VALUES:
+      {
+        LogValuesData data;
+        memcpy(&data, &e.data, sizeof(LogValuesData));
+        p = put(p, &data.water, sizeof(data.water));
+        p = put(p, &data.ambient, sizeof(data.ambient));
+        p = put(p, &data.flags, sizeof(data.flags));
+      }
+      break;
+    case LogDataType::STATE:
+      {
+        LogStateData data;
+        memcpy(&data, &e.data, sizeof(LogStateData));
+        p = put(p, &data.previous, sizeof(data.previous));
+        p = put(p, &data.current, sizeof(data.current));
+        p = put(p, &data.event, sizeof(data.event));
+      }
+      break;
+    case LogDataType::CONFIG:
+      {
+        LogConfigParamData data;
+        memcpy(&data, &e.data, sizeof(LogConfigParamData));
+        int32_t value = logConfigValue(data);
+        p = put(p, &data.id, sizeof(data.id));
+        p = put(p, &value, sizeof(value));
+      }
+      break;
+    default:
+      break;
+  }
+  return size;
+  #endif
+}
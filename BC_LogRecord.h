@@ -0,0 +1,59 @@
+#ifndef BC_LOG_RECORD_H_INCLUDED
+  #define BC_LOG_RECORD_H_INCLUDED
+
+  #include <ACF_Logging.h>
+
+  /*
+   * Encoding of a LogEntry for transmission (LOG_ENTRY_CID, FRAME_LOG_ENTRY). By default, a record is the LogEntry as
+   * it is, so existing hosts keep working.
+   *
+   * With LOG_RECORD_COMPACT defined, entries are sent as compact, versioned records instead. A LogEntry always
+   * carries the largest LogData member plus padding; a compact record only holds the fields of the entry's type:
+   *
+   *   header:  version (high nibble) | LogDataType (low nibble) (1 byte), timestamp
+   *   MESSAGE: id, p1, p2
+   *   VALUES:  water, ambient, flags
+   *   STATE:   previous, current, event
+   *   CONFIG:  id, new value [1/100] (int32_t)
+   *
+   * Fields are packed without padding, little endian (native byte order). The type in the header determines the size
+   * of the record, see logRecordSize(). Readers must ignore records of an unknown version. The BLE service UUID
+   * differs between both formats, so hosts expecting the other one don't find the service instead of misreading 
+   * the records.
+   *
+   * The log in FRAM always holds LogEntry's, its format belongs to the control library.
+   */
+  // #define LOG_RECORD_COMPACT
+
+  #define LOG_RECORD_VERSION 1
+
+  #define LOG_RECORD_HEADER_SIZE  (1 + sizeof(ACF_Timestamp))
+  #define LOG_RECORD_MESSAGE_SIZE (sizeof(LogMessageData::id) + sizeof(LogMessageData::params))
+  #define LOG_RECORD_VALUES_SIZE  (sizeof(LogValuesData::water) + sizeof(LogValuesData::ambient) + sizeof(LogValuesData::flags))
+  #define LOG_RECORD_STATE_SIZE   (sizeof(LogStateData::previous) + sizeof(LogStateData::current) + sizeof(LogStateData::event))
+  #define LOG_RECORD_CONFIG_SIZE  (sizeof(LogConfigParamData::id) + sizeof(int32_t))
+
+  #ifdef LOG_RECORD_COMPACT
+    #define LOG_RECORD_MIN_SIZE (LOG_RECORD_HEADER_SIZE + LOG_RECORD_STATE_SIZE)
+    #define LOG_RECORD_MAX_SIZE (LOG_RECORD_HEADER_SIZE + LOG_RECORD_MESSAGE_SIZE)
+  #else
+    #define LOG_RECORD_MIN_SIZE sizeof(LogEntry)
+    #define LOG_RECORD_MAX_SIZE sizeof(LogEntry)
+  #endif
+
+  /*
+   * Size [bytes] of the compact record of the given type including the header, 0 for unknown types.
+   */
+  uint8_t logRecordSize(LogDataType type);
+
+  /*
+   * New value of a CONFIG entry [1/100], rounded.
+   */
+  int32_t logConfigValue(const LogConfigParamData &data);
+
+  /*
+   * Encodes e into record (LOG_RECORD_MAX_SIZE bytes). Returns the size of the record, 0 if the type of e is unknown.
+   */
+  uint8_t encodeLogRecord(const LogEntry &e, uint8_t record[]);
+
+#endif
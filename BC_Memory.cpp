@@ -0,0 +1,49 @@
+#include "BC_Memory.h"
+
+#if defined(__AVR__)
+  extern uint8_t __heap_start;
+  extern void *__brkval;
+
+  static uint8_t *heapEnd() {
+    return __brkval != NULL ? (uint8_t *) __brkval : &__heap_start;
+  }
+  #define MEMORY_INFO_SUPPORTED
+#elif defined(__arm__)
+  extern "C" char *sbrk(int incr);
+
+  static uint8_t *heapEnd() {
+    return (uint8_t *) sbrk(0);
+  }
+  #define MEMORY_INFO_SUPPORTED
+#endif
+
+void paintStack() {
+  #ifdef MEMORY_INFO_SUPPORTED
+    uint8_t top;
+    for (uint8_t *p = heapEnd(); p < &top - STACK_PAINT_GUARD; p++) {
+      *p = STACK_PAINT;
+    }
+  #endif
+}
+
+int32_t stackHeadroom() {
+  #ifdef MEMORY_INFO_SUPPORTED
+    uint8_t top;
+    uint8_t *p = heapEnd();
+    while (p < &top && *p == STACK_PAINT) {
+      p++;
+    }
+    return p - heapEnd();
+  #else
+    return -1L;
+  #endif
+}
+
+int32_t freeMemory() {
+  #ifdef MEMORY_INFO_SUPPORTED
+    uint8_t top;
+    return &top - heapEnd();
+  #else
+    return -1L;
+  #endif
+}
@@ -0,0 +1,67 @@
+#ifndef BC_MEMORY_H_INCLUDED
+  #define BC_MEMORY_H_INCLUDED
+
+  #include <ACF_Types.h>
+
+  /*
+   * SRAM budgets [bytes] of the sketch's subsystems, checked at compile time. All objects are placed statically
+   * (no heap), so these plus the library objects and the stack make up the RAM in use.
+   */
+  #define RAM_BUDGET_LOGGING           96  // LogTypeIndex
+  #define RAM_BUDGET_HEATER           128  // HeaterControl, CutOutGuard
+  #define RAM_BUDGET_SENSORS          112  // SensorReadout incl. the filter window
+  #define RAM_BUDGET_ROLLUPS          128
+  #if defined(__AVR__)
+    #define RAM_BUDGET_FLIGHT_RECORDER 32  // the ring is in FRAM
+  #else
+    #define RAM_BUDGET_FLIGHT_RECORDER 576
+  #endif
+  #define RAM_BUDGET_SCHEDULER         96
+  #define RAM_BUDGET_ENERGY            64
+  // the library objects in the controller (FRAM stores, Log, ConfigParams, OneWire, sensors, automaton, ...):
+  #define RAM_BUDGET_LIBRARIES        384
+  #define RAM_BUDGET_UI               512  // the UI object(s) passed to the controller
+
+  // all of BC_Controller:
+  #define RAM_BUDGET_CONTROLLER (RAM_BUDGET_LOGGING + RAM_BUDGET_HEATER + RAM_BUDGET_SENSORS + RAM_BUDGET_ROLLUPS \
+    + RAM_BUDGET_FLIGHT_RECORDER + RAM_BUDGET_SCHEDULER + RAM_BUDGET_ENERGY + RAM_BUDGET_LIBRARIES)
+
+  /*
+   * SRAM of the target MCU and what is needed beyond the budgets: the globals of the Arduino core and the libraries 
+   * outside the controller (Serial and I2C buffers, ...) and the stack (check the headroom with 'stat').
+   */
+  #if defined(__AVR__)
+    #define MCU_SRAM_SIZE (RAMEND - RAMSTART + 1)  // 2560 on the ATmega32u4
+    #define RAM_RESERVE_CORE   320
+    #define RAM_RESERVE_STACK  512
+  #elif defined(ARDUINO_ARCH_SAMD)
+    #define MCU_SRAM_SIZE    32768  // SAMD21
+    #define RAM_RESERVE_CORE  1024
+    #define RAM_RESERVE_STACK 2048
+  #endif
+
+  #ifdef MCU_SRAM_SIZE
+    static_assert(RAM_BUDGET_CONTROLLER + RAM_BUDGET_UI + RAM_RESERVE_CORE + RAM_RESERVE_STACK <= MCU_SRAM_SIZE, 
+      "the RAM budgets exceed the SRAM of the MCU");
+  #endif
+
+  #define STACK_PAINT 0xC5  // fill byte of the unused RAM between heap and stack
+  #define STACK_PAINT_GUARD 32 // [bytes] left unpainted below the stack pointer of paintStack()
+
+  /*
+   * Fills the free RAM between heap and stack with STACK_PAINT. Call first thing in setup().
+   */
+  void paintStack();
+
+  /*
+   * Painted bytes never overwritten since paintStack(), i.e. the min. distance there has been between heap and stack.
+   * Returns -1 if unsupported on the MCU.
+   */
+  int32_t stackHeadroom();
+
+  /*
+   * Current distance [bytes] between heap and stack. Returns -1 if unsupported on the MCU.
+   */
+  int32_t freeMemory();
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef BC_MESSAGES_H_INCLUDED
+  #define BC_MESSAGES_H_INCLUDED
+
+  #include <ACF_Messages.h>
+
+  /*
+   * IDs of the log messages written by the sketch itself (the library's messages use the lower IDs).
+   */
+  enum class BC_Msg : T_Message_ID {
+    CONFIG_BATCH = 1000, // p1: bit mask of the changed ConfigParam IDs, p2: number of params in the batch
+    WARM_RESTART = 1001, // p1: resumed state, p2: restored heating time [min]
+    PREHEAT_START = 1002, // p1: schedule slot, p2: estimated heating time [min]
+    ENERGY_SESSION = 1003, // p1: energy [Wh] of the ended session, p2: lifetime energy [kWh]
+    ENERGY_DAY = 1004      // p1: energy [Wh] of the ended day, p2: lifetime energy [kWh]
+  };
+
+#endif
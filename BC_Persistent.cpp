@@ -0,0 +1,18 @@
+#include "BC_Persistent.h"
+
+uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc) {
+  while (len--) {
+    crc ^= (uint16_t) *data++ << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+uint32_t fnv1a(const uint8_t *data, uint16_t len, uint32_t hash) {
+  while (len--) {
+    hash = (hash ^ *data++) * FNV_PRIME;
+  }
+  return hash;
+}
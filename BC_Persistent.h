@@ -0,0 +1,103 @@
+#ifndef BC_PERSISTENT_H_INCLUDED
+  #define BC_PERSISTENT_H_INCLUDED
+
+  #include <ACF_FRAM.h>
+
+  /*
+   * CRC-16/CCITT-FALSE.
+   */
+  uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc = 0xFFFF);
+
+  #define FNV_OFFSET_BASIS 2166136261UL
+  #define FNV_PRIME        16777619UL
+
+  /*
+   * 32-bit FNV-1a hash; pass the previous result as hash to continue it.
+   */
+  uint32_t fnv1a(const uint8_t *data, uint16_t len, uint32_t hash = FNV_OFFSET_BASIS);
+
+  struct PersistentBlockHeader {
+    // incremented with every save; the copy with the higher sequence number is the current one:
+    uint16_t sequence;
+    // CRC over the sequence number and the data:
+    uint16_t crc;
+  };
+
+  /*
+   * A block of data stored twice (double-buffered) in a FRAM store. Every save overwrites the older copy, so an
+   * interrupted write (power loss, reset) never destroys the most recent valid state. Each copy is protected by a CRC.
+   */
+  template<class T> class PersistentBlock {
+    public:
+      // FRAM bytes needed for a block:
+      static const uint16_t STORE_SIZE = 2 * (sizeof(PersistentBlockHeader) + sizeof(T));
+
+      PersistentBlock(FRAMStore *store, uint16_t offset = 0) {
+        this->store = store;
+        this->offset = offset;
+      }
+
+      /*
+       * Loads the most recent valid copy into data. Returns false (data unchanged) if neither copy is valid.
+       */
+      boolean load(T &data) {
+        int8_t current = -1;
+        PersistentBlockHeader header[2];
+        T copy;
+        for (uint8_t i = 0; i < 2; i++) {
+          if (readCopy(i, header[i], copy) && (current < 0 || (int16_t) (header[i].sequence - header[current].sequence) > 0)) {
+            current = i;
+            data = copy;
+          }
+        }
+        if (current < 0) {
+          return false;
+        }
+        currentCopy = current;
+        sequence = header[current].sequence;
+        return true;
+      }
+
+      /*
+       * Saves data to the older of the two copies.
+       */
+      void save(const T &data) {
+        PersistentBlockHeader header;
+        header.sequence = ++sequence;
+        header.crc = crc16((const uint8_t *) &data, sizeof(T), crc16((const uint8_t *) &header.sequence, sizeof(header.sequence)));
+        currentCopy = currentCopy == 0 ? 1 : 0;
+        uint16_t base = copyOffset(currentCopy);
+        store->writeBytes(base + sizeof(PersistentBlockHeader), (const uint8_t *) &data, sizeof(T));
+        // header last => an interrupted data write leaves an invalid CRC:
+        store->writeBytes(base, (const uint8_t *) &header, sizeof(PersistentBlockHeader));
+      }
+
+      /*
+       * Invalidates both copies.
+       */
+      void clear() {
+        PersistentBlockHeader header = { 0, 0 };
+        store->writeBytes(copyOffset(0), (const uint8_t *) &header, sizeof(PersistentBlockHeader));
+        store->writeBytes(copyOffset(1), (const uint8_t *) &header, sizeof(PersistentBlockHeader));
+        sequence = 0;
+      }
+
+    protected:
+      FRAMStore *store;
+      uint16_t offset;
+      uint16_t sequence = 0;
+      uint8_t currentCopy = 1;
+
+      uint16_t copyOffset(uint8_t copy) {
+        return offset + copy * (sizeof(PersistentBlockHeader) + sizeof(T));
+      }
+
+      boolean readCopy(uint8_t copy, PersistentBlockHeader &header, T &data) {
+        uint16_t base = copyOffset(copy);
+        store->readBytes(base, (uint8_t *) &header, sizeof(PersistentBlockHeader));
+        store->readBytes(base + sizeof(PersistentBlockHeader), (uint8_t *) &data, sizeof(T));
+        return header.crc == crc16((const uint8_t *) &data, sizeof(T), crc16((const uint8_t *) &header.sequence, sizeof(header.sequence)));
+      }
+  };
+
+#endif
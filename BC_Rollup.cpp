@@ -0,0 +1,138 @@
+#include "BC_Rollup.h"
+
+void RollupRecord::clear(uint32_t period) {
+  memset(this, 0, sizeof(RollupRecord));
+  this->period = period;
+  waterMin = ambientMin = ACF_UNDEFINED_TEMPERATURE;
+  waterMax = ambientMax = ACF_UNDEFINED_TEMPERATURE;
+}
+
+void RollupRecord::merge(const RollupRecord &r) {
+  if (r.waterSamples > 0) {
+    if (waterSamples == 0 || r.waterMin < waterMin) waterMin = r.waterMin;
+    if (waterSamples == 0 || r.waterMax > waterMax) waterMax = r.waterMax;
+  }
+  if (r.ambientSamples > 0) {
+    if (ambientSamples == 0 || r.ambientMin < ambientMin) ambientMin = r.ambientMin;
+    if (ambientSamples == 0 || r.ambientMax > ambientMax) ambientMax = r.ambientMax;
+  }
+  waterSamples += r.waterSamples;
+  waterSum += r.waterSum;
+  ambientSamples += r.ambientSamples;
+  ambientSum += r.ambientSum;
+  heaterOnSeconds += r.heaterOnSeconds;
+  energy += r.energy;
+  uptimeMillis += r.uptimeMillis;
+}
+
+ACF_Temperature RollupRecord::waterMean() const {
+  return waterSamples == 0 ? ACF_UNDEFINED_TEMPERATURE : waterSum / waterSamples;
+}
+
+ACF_Temperature RollupRecord::ambientMean() const {
+  return ambientSamples == 0 ? ACF_UNDEFINED_TEMPERATURE : ambientSum / ambientSamples;
+}
+
+void Rollups::init() {
+  store->readBytes(0, (uint8_t *) &header, sizeof(RollupHeader));
+  if (header.magic != ROLLUP_MAGIC) {
+    header.magic = ROLLUP_MAGIC;
+    header.hours = 0L;
+    header.days = 0L;
+    header.hoursInDay = 0;
+    hour.clear(header.hours++);
+    day.clear(header.days++);
+    writeHeader();
+    writeRecord(ROLLUP_HOUR, hour);
+    writeRecord(ROLLUP_DAY, day);
+  } else {
+    // continue the current periods (the downtime is not counted):
+    store->readBytes(recordOffset(ROLLUP_HOUR, header.hours - 1), (uint8_t *) &hour, sizeof(RollupRecord));
+    store->readBytes(recordOffset(ROLLUP_DAY, header.days - 1), (uint8_t *) &day, sizeof(RollupRecord));
+  }
+  lastUpdate = millis();
+}
+
+uint16_t Rollups::recordOffset(RollupPeriod period, uint32_t seq) {
+  if (period == ROLLUP_HOUR) {
+    return sizeof(RollupHeader) + (seq % ROLLUP_HOURS) * sizeof(RollupRecord);
+  }
+  return sizeof(RollupHeader) + (ROLLUP_HOURS + seq % ROLLUP_DAYS) * sizeof(RollupRecord);
+}
+
+void Rollups::writeHeader() {
+  store->writeBytes(0, (const uint8_t *) &header, sizeof(RollupHeader));
+}
+
+void Rollups::writeRecord(RollupPeriod period, const RollupRecord &r) {
+  store->writeBytes(recordOffset(period, r.period), (const uint8_t *) &r, sizeof(RollupRecord));
+}
+
+void Rollups::addSample(RollupRecord &r, ACF_Temperature water, ACF_Temperature ambient) {
+  if (water != ACF_UNDEFINED_TEMPERATURE) {
+    if (r.waterSamples == 0 || water < r.waterMin) r.waterMin = water;
+    if (r.waterSamples == 0 || water > r.waterMax) r.waterMax = water;
+    r.waterSum += water;
+    r.waterSamples++;
+  }
+  if (ambient != ACF_UNDEFINED_TEMPERATURE) {
+    if (r.ambientSamples == 0 || ambient < r.ambientMin) r.ambientMin = ambient;
+    if (r.ambientSamples == 0 || ambient > r.ambientMax) r.ambientMax = ambient;
+    r.ambientSum += ambient;
+    r.ambientSamples++;
+  }
+}
+
+void Rollups::completeHour() {
+  writeRecord(ROLLUP_HOUR, hour);
+  day.merge(hour);
+  writeRecord(ROLLUP_DAY, day);
+  if (++header.hoursInDay >= ROLLUP_HOURS_PER_DAY) {
+    header.hoursInDay = 0;
+    day.clear(header.days++);
+    writeRecord(ROLLUP_DAY, day);
+  }
+  hour.clear(header.hours++);
+  writeHeader();
+}
+
+void Rollups::update(TimeMillis now, ACF_Temperature water, ACF_Temperature ambient, uint32_t heaterOnMillis, uint32_t heaterPower) {
+  TimeMillis elapsed = now - lastUpdate;
+  lastUpdate = now;
+  // credit whole seconds of the heater on-time, the rest is credited with the next cycle:
+  uint32_t onSeconds = (heaterOnMillis - creditedOnMillis) / 1000L;
+  creditedOnMillis += onSeconds * 1000L;
+  pendingEnergy += onSeconds * heaterPower;
+
+  hour.uptimeMillis += elapsed;
+  if (hour.uptimeMillis >= ROLLUP_HOUR_MILLIS) {
+    uint32_t carry = hour.uptimeMillis - ROLLUP_HOUR_MILLIS;
+    hour.uptimeMillis = ROLLUP_HOUR_MILLIS;
+    completeHour();
+    hour.uptimeMillis = carry;
+  }
+  addSample(hour, water, ambient);
+  hour.heaterOnSeconds += onSeconds;
+  hour.energy += pendingEnergy / 3600L;
+  pendingEnergy %= 3600L;
+  writeRecord(ROLLUP_HOUR, hour);
+}
+
+uint16_t Rollups::available(RollupPeriod period) {
+  uint32_t count = period == ROLLUP_HOUR ? header.hours : header.days;
+  uint16_t size = period == ROLLUP_HOUR ? ROLLUP_HOURS : ROLLUP_DAYS;
+  return count < size ? count : size;
+}
+
+boolean Rollups::read(RollupPeriod period, uint16_t age, RollupRecord &record) {
+  if (age >= available(period)) {
+    return false;
+  }
+  uint32_t count = period == ROLLUP_HOUR ? header.hours : header.days;
+  store->readBytes(recordOffset(period, count - 1 - age), (uint8_t *) &record, sizeof(RollupRecord));
+  if (period == ROLLUP_DAY && age == 0) {
+    // the current day record holds its complete hours only:
+    record.merge(hour);
+  }
+  return true;
+}
@@ -0,0 +1,106 @@
+#ifndef BC_ROLLUP_H_INCLUDED
+  #define BC_ROLLUP_H_INCLUDED
+
+  #include <ACF_FRAM.h>
+
+  #define ROLLUP_HOURS   48  // hourly records kept (ring)
+  #define ROLLUP_DAYS    62  // daily records kept (ring)
+  #define ROLLUP_MAGIC   0xB1C8
+
+  #define ROLLUP_HOUR_MILLIS     3600000L
+  #define ROLLUP_HOURS_PER_DAY   24
+
+  typedef enum {
+    ROLLUP_HOUR = 0,
+    ROLLUP_DAY = 1
+  } RollupPeriod;
+
+  /*
+   * Aggregated sensor values and heater usage of one hour or one day. A day is 24 hours of uptime (the downtimes
+   * are not counted), not a calendar day.
+   */
+  struct RollupRecord {
+    // sequence number of the period (hours or days since the rollups were started; downtimes are not counted):
+    uint32_t period;
+    uint16_t waterSamples;
+    ACF_Temperature waterMin;
+    ACF_Temperature waterMax;
+    int32_t waterSum;
+    uint16_t ambientSamples;
+    ACF_Temperature ambientMin;
+    ACF_Temperature ambientMax;
+    int32_t ambientSum;
+    uint32_t heaterOnSeconds;
+    // [Wh]:
+    uint32_t energy;
+    // [ms] uptime covered by the record:
+    uint32_t uptimeMillis;
+
+    void clear(uint32_t period);
+    void merge(const RollupRecord &r);
+    ACF_Temperature waterMean() const;
+    ACF_Temperature ambientMean() const;
+  };
+
+  struct RollupHeader {
+    uint16_t magic;
+    // number of hour records started (the current one included):
+    uint32_t hours;
+    // number of day records started (the current one included):
+    uint32_t days;
+    // complete hours within the current day:
+    uint8_t hoursInDay;
+  };
+
+  #define ROLLUP_STORE_SIZE (sizeof(RollupHeader) + (ROLLUP_HOURS + ROLLUP_DAYS) * sizeof(RollupRecord))
+
+  /*
+   * Long-term history of hourly and daily aggregates. Every sensor cycle updates the record of the current hour in
+   * O(1) and writes it through to FRAM, so at most one cycle is lost on a reset. The day record holds the complete
+   * hours of the current day; it and the header are written only when an hour is complete. After a restart, the
+   * current hour and day records are continued.
+   */
+  class Rollups {
+    public:
+      Rollups(FRAMStore *store) {
+        this->store = store;
+      }
+
+      void init();
+
+      /*
+       * Adds one sensor cycle: the values of the sensors that are OK (others: ACF_UNDEFINED_TEMPERATURE),
+       * the total heater on-time since boot [ms] and the heater power [W].
+       */
+      void update(TimeMillis now, ACF_Temperature water, ACF_Temperature ambient, uint32_t heaterOnMillis, uint32_t heaterPower);
+
+      /*
+       * Number of records available for the given period (the current one included).
+       */
+      uint16_t available(RollupPeriod period);
+
+      /*
+       * Reads a record: age 0 is the current (incomplete) period, 1 the most recent complete one, etc.
+       * Returns false if no such record is available.
+       */
+      boolean read(RollupPeriod period, uint16_t age, RollupRecord &record);
+
+    protected:
+      FRAMStore *store;
+      RollupHeader header;
+      RollupRecord hour;
+      RollupRecord day;
+      TimeMillis lastUpdate = 0L;
+      // [ms] heater on-time since boot credited to the records:
+      uint32_t creditedOnMillis = 0L;
+      // [W * s] energy not yet credited to the records (below 1 Wh):
+      uint32_t pendingEnergy = 0L;
+
+      uint16_t recordOffset(RollupPeriod period, uint32_t seq);
+      void addSample(RollupRecord &r, ACF_Temperature water, ACF_Temperature ambient);
+      void completeHour();
+      void writeHeader();
+      void writeRecord(RollupPeriod period, const RollupRecord &r);
+  };
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef BC_RUNTIME_H_INCLUDED
+  #define BC_RUNTIME_H_INCLUDED
+
+  #include "BC_Stats.h"
+  #include "BC_HeaterControl.h"
+  #include "BC_LogIndex.h"
+  #include "BC_Rollup.h"
+  #include "BC_FlightRecorder.h"
+  #include "BC_Schedule.h"
+  #include "BC_Energy.h"
+  #include "BC_SensorReadout.h"
+
+  /*
+   * Sketch-level components of the controller that the UIs need to access in addition to the ExecutionContext.
+   */
+  struct RuntimeContext {
+    BoilerStateAutomaton *automaton;
+    RuntimeStats *stats;
+    HeaterControl *heaterControl;
+    LogTypeIndex *logIndex;
+    Rollups *rollups;
+    // FRAM reserved for the UI (UI_STORE_SIZE bytes):
+    FRAMStore *uiStore;
+    FlightRecorder *flightRecorder;
+    PreheatScheduler *scheduler;
+    EnergyMeter *energy;
+    SensorReadout *sensorReadout;
+  };
+
+#endif
@@ -0,0 +1,212 @@
+#include "BC_Schedule.h"
+
+// #define DEBUG_SCHEDULE
+
+#define TARGET_TOLERANCE 100 // [°C * 100] a target is missed if the water is colder than this at the deadline
+
+void PreheatScheduler::init(ExecutionContext *context) {
+  this->context = context;
+  persistent.load(params);
+  for (uint8_t i = 0; i < PREHEAT_SLOTS; i++) {
+    startedDay[i] = 0xFFFF;
+    checkedDay[i] = 0xFFFF;
+  }
+}
+
+void PreheatScheduler::setClock(TimeMillis now, uint16_t minuteOfDay) {
+  if (!clockIsSet) {
+    clockMinutes = MINUTES_PER_DAY + minuteOfDay;
+  } else {
+    advanceClock(now);
+    // the time of day on the current day, or on the day before/after if that is closer:
+    uint32_t minutes = (clockMinutes / MINUTES_PER_DAY) * MINUTES_PER_DAY + minuteOfDay;
+    if (minutes + MINUTES_PER_DAY / 2 < clockMinutes) {
+      minutes += MINUTES_PER_DAY;
+    } else if (minutes > clockMinutes + MINUTES_PER_DAY / 2 && minutes >= MINUTES_PER_DAY) {
+      minutes -= MINUTES_PER_DAY;
+    }
+    clockMinutes = minutes;
+  }
+  clockTick = now;
+  clockIsSet = true;
+}
+
+void PreheatScheduler::advanceClock(TimeMillis now) {
+  // wrap-around safe; a now older than clockTick (taken earlier in the loop) does not move the clock:
+  int32_t elapsed = now - clockTick;
+  if (elapsed >= 60000L) {
+    clockMinutes += elapsed / 60000L;
+    clockTick += (elapsed / 60000L) * 60000L;
+  }
+}
+
+uint16_t PreheatScheduler::minuteOfDay(TimeMillis now) {
+  advanceClock(now);
+  return clockMinutes % MINUTES_PER_DAY;
+}
+
+uint16_t PreheatScheduler::dayNumber(TimeMillis now) {
+  advanceClock(now);
+  return clockMinutes / MINUTES_PER_DAY;
+}
+
+boolean PreheatScheduler::setSlot(uint8_t slot, uint16_t readyMinute, ACF_Temperature targetTemp) {
+  if (slot >= PREHEAT_SLOTS || (readyMinute >= MINUTES_PER_DAY && readyMinute != PREHEAT_SLOT_UNUSED)) {
+    return false;
+  }
+  if (readyMinute != PREHEAT_SLOT_UNUSED && (targetTemp <= 0 || targetTemp >= context->config->heaterCutOutWaterTemp)) {
+    return false;
+  }
+  params.slots[slot].readyMinute = readyMinute;
+  params.slots[slot].targetTemp = targetTemp;
+  persistent.save(params);
+  startedDay[slot] = 0xFFFF;
+  return true;
+}
+
+boolean PreheatScheduler::sensorsOk() {
+  return context->op->water.sensorStatus == DS18B20_SENSOR_OK && context->op->ambient.sensorStatus == DS18B20_SENSOR_OK;
+}
+
+TimeSeconds PreheatScheduler::estimatedHeatingTime(ACF_Temperature targetTemp) {
+  DS18B20_Sensor *water = &context->op->water;
+  DS18B20_Sensor *ambient = &context->op->ambient;
+  int32_t power = heaterPowerW(context->config);
+  if (water->sensorStatus != DS18B20_SENSOR_OK || power == 0) {
+    return UNDEFINED_TIME_SECONDS;
+  }
+  int32_t delta = (int32_t) targetTemp - water->currentTemp;
+  if (delta <= 0) {
+    return 0L;
+  }
+  uint32_t capacity = tankCapacityMl(context->config);
+
+  // losses [W] at the mean water temperature during heating:
+  int32_t lossPower = 0L;
+  if (ambient->sensorStatus == DS18B20_SENSOR_OK) {
+    int32_t excess = ((int32_t) targetTemp + water->currentTemp) / 2 - ambient->currentTemp;
+    if (excess > 0) {
+      lossPower = (int64_t) heatingEnergy(capacity, excess) * params.lossRate / (HEAT_LOSS_RATE_SCALE * 3600L);
+    }
+  }
+  // the heater always makes some progress:
+  int32_t effectivePower = max(power - lossPower, power / 10);
+  return heatingEnergy(capacity, delta) / effectivePower;
+}
+
+void PreheatScheduler::learnLosses(TimeMillis now, boolean heaterOn) {
+  if (heaterOn || !sensorsOk()) {
+    lossStartTemp = ACF_UNDEFINED_TEMPERATURE;
+    return;
+  }
+  ACF_Temperature water = context->op->water.currentTemp;
+  if (lossStartTemp == ACF_UNDEFINED_TEMPERATURE) {
+    lossStart = now;
+    lossStartTemp = water;
+    return;
+  }
+  if (now - lossStart < HEAT_LOSS_WINDOW) {
+    return;
+  }
+  int32_t drop = (int32_t) lossStartTemp - water;
+  int32_t excess = ((int32_t) lossStartTemp + water) / 2 - context->op->ambient.currentTemp;
+  if (excess >= HEAT_LOSS_MIN_EXCESS && drop >= 0) {
+    // k = drop / (excess * elapsed hours), averaged with the previous estimate:
+    int32_t k = (int64_t) drop * HEAT_LOSS_RATE_SCALE * 3600000L / ((int64_t) excess * (now - lossStart));
+    params.lossRate = (3L * params.lossRate + constrain(k, (int32_t) 0, (int32_t) UINT16_MAX)) / 4;
+    persistent.save(params);
+    #ifdef DEBUG_SCHEDULE
+      Serial.print(F("DEBUG_SCHEDULE: loss rate "));
+      Serial.println(params.lossRate);
+    #endif
+  }
+  lossStart = now;
+  lossStartTemp = water;
+}
+
+void PreheatScheduler::update(TimeMillis now, boolean heaterOn) {
+  learnLosses(now, heaterOn);
+  if (!clockIsSet) {
+    return;
+  }
+  uint16_t nowMinute = minuteOfDay(now);
+  uint16_t today = dayNumber(now);
+
+  for (uint8_t i = 0; i < PREHEAT_SLOTS; i++) {
+    PreheatSlot *slot = &params.slots[i];
+    if (slot->readyMinute == PREHEAT_SLOT_UNUSED) {
+      continue;
+    }
+    if (slot->readyMinute == nowMinute && checkedDay[i] != today) {
+      checkedDay[i] = today;
+      if (startedDay[i] == today && (context->op->water.sensorStatus != DS18B20_SENSOR_OK
+                                     || context->op->water.currentTemp < slot->targetTemp - TARGET_TOLERANCE)) {
+        missed++;
+      }
+    }
+
+    uint16_t deadlineDay = slot->readyMinute < nowMinute ? today + 1 : today;
+    if (activeSlot >= 0 || startedDay[i] == deadlineDay) {
+      continue;
+    }
+    TimeSeconds heatingTime = estimatedHeatingTime(slot->targetTemp);
+    if (heatingTime == UNDEFINED_TIME_SECONDS) {
+      continue;
+    }
+    TimeSeconds secondsLeft = ((slot->readyMinute + MINUTES_PER_DAY - nowMinute) % MINUTES_PER_DAY) * 60L;
+    if (heatingTime + heatingTime / 10 + PREHEAT_MARGIN >= secondsLeft) {
+      activeSlot = i;
+      step = 0;
+      startedDay[i] = deadlineDay;
+      started++;
+      context->log->logMessage(static_cast<T_Message_ID>(BC_Msg::PREHEAT_START), i, heatingTime / 60L);
+    }
+  }
+}
+
+boolean PreheatScheduler::nextRequest(BoilerStateAutomaton *automaton, UserRequest *request) {
+  UserCommands accepted = automaton->acceptedUserCommands();
+  if (activeSlot < 0) {
+    if (params.savedTargetTemp == ACF_UNDEFINED_TEMPERATURE
+        || automaton->state()->id() == States::HEATING || !(accepted & CMD_CONFIG_SET_VALUE)) {
+      return false;
+    }
+    boolean restore = context->config->targetTemp != params.savedTargetTemp;
+    if (restore) {
+      request->setParamValue(ConfigParam::TARGET_TEMP, (int32_t) params.savedTargetTemp);
+    }
+    params.savedTargetTemp = ACF_UNDEFINED_TEMPERATURE;
+    persistent.save(params);
+    return restore;
+  }
+  ACF_Temperature targetTemp = params.slots[activeSlot].targetTemp;
+  // one command per call, each is tried once:
+  while (step < 3) {
+    switch (step++) {
+      case 0:
+        if (context->config->targetTemp != targetTemp && (accepted & CMD_CONFIG_SET_VALUE)) {
+          if (params.savedTargetTemp == ACF_UNDEFINED_TEMPERATURE) {
+            params.savedTargetTemp = context->config->targetTemp;
+            persistent.save(params);
+          }
+          request->setParamValue(ConfigParam::TARGET_TEMP, (int32_t) targetTemp);
+          return true;
+        }
+        break;
+      case 1:
+        if (!context->op->loggingValues && (accepted & CMD_REC_ON)) {
+          request->setCommand(CMD_REC_ON);
+          return true;
+        }
+        break;
+      case 2:
+        if (automaton->state()->id() != States::HEATING && (accepted & CMD_HEAT_ON)) {
+          request->setCommand(CMD_HEAT_ON);
+          return true;
+        }
+        break;
+    }
+  }
+  activeSlot = -1;
+  return false;
+}
@@ -0,0 +1,112 @@
+#ifndef BC_SCHEDULE_H_INCLUDED
+  #define BC_SCHEDULE_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include <BC_State.h>
+  #include "BC_Persistent.h"
+  #include "BC_Messages.h"
+  #include "BC_Fixed.h"
+
+  #define PREHEAT_SLOTS 4
+  #define PREHEAT_SLOT_UNUSED 0xFFFF
+  #define MINUTES_PER_DAY 1440
+
+  #define PREHEAT_MARGIN                600L // [s] added to the estimated heating time (plus 10 %)
+  #define HEAT_LOSS_RATE_SCALE       100000L // heat-loss rate unit: 1 / (100'000 h)
+  #define DEFAULT_HEAT_LOSS_RATE       3000  // [1 / (100'000 h)] i.e. 3 % of the excess temperature per hour
+  #define HEAT_LOSS_WINDOW      (30L * 60000L) // [ms] cooling observed with the heater off for a new loss estimate
+  #define HEAT_LOSS_MIN_EXCESS          500  // [°C * 100] water must be this much warmer than ambient to learn
+
+  /*
+   * "Hot water ready by readyMinute [min after midnight] at targetTemp".
+   */
+  struct PreheatSlot {
+    uint16_t readyMinute = PREHEAT_SLOT_UNUSED;
+    ACF_Temperature targetTemp = 0;
+  };
+
+  struct PreheatParams {
+    PreheatSlot slots[PREHEAT_SLOTS];
+    // learned heat-loss rate k [1 / (HEAT_LOSS_RATE_SCALE h)] of dT/dt = -k * (water - ambient):
+    uint16_t lossRate = DEFAULT_HEAT_LOSS_RATE;
+    // the user's target temperature replaced by a preheat, to be restored afterwards (undefined -> none):
+    ACF_Temperature savedTargetTemp = ACF_UNDEFINED_TEMPERATURE;
+  };
+
+  #define PREHEAT_STORE_SIZE (PersistentBlock<PreheatParams>::STORE_SIZE)
+
+  /*
+   * Deadline-driven preheating: for every slot, the heating time is estimated from the tank capacity, the heater
+   * power, the current water and ambient temperatures and the learned heat losses. At the latest safe moment, the
+   * scheduler issues the user commands that start heating to the slot's target (config set target temp, rec on,
+   * heat on), the same way as a user would. Once heating has ended (or could not be started), the user's target
+   * temperature is set again; it is kept in FRAM until then, so it survives a reset.
+   * There is no RTC: the time of day is known only after it has been set (console: 'time HH:MM') since boot.
+   */
+  class PreheatScheduler {
+    public:
+      PreheatScheduler(FRAMStore *store) : persistent(store) {}
+
+      void init(ExecutionContext *context);
+
+      /*
+       * Sets the time of day [min after midnight] at now. Once the clock is set, a correction keeps the day number
+       * unless it moves the time across midnight.
+       */
+      void setClock(TimeMillis now, uint16_t minuteOfDay);
+      boolean clockSet() { return clockIsSet; }
+      uint16_t minuteOfDay(TimeMillis now);
+      // days since the clock was first set (day 1):
+      uint16_t dayNumber(TimeMillis now);
+
+      /*
+       * Returns false if slot or values are out of range. readyMinute = PREHEAT_SLOT_UNUSED clears the slot.
+       */
+      boolean setSlot(uint8_t slot, uint16_t readyMinute, ACF_Temperature targetTemp);
+
+      /*
+       * Estimated time [s] to heat from the current water temperature to targetTemp (without margin);
+       * UNDEFINED_TIME_SECONDS if the temperatures or the heater power are not known.
+       */
+      TimeSeconds estimatedHeatingTime(ACF_Temperature targetTemp);
+
+      /*
+       * Call after every sensor readout (learns the heat losses, checks the deadlines).
+       */
+      void update(TimeMillis now, boolean heaterOn);
+
+      /*
+       * Call while there is no pending user request: fills in the next request of a due preheat, or the request
+       * restoring the user's target temperature after a preheat. Returns false if there is none.
+       */
+      boolean nextRequest(BoilerStateAutomaton *automaton, UserRequest *request);
+
+      PreheatParams params;
+      // number of preheats started / of targets not reached by their deadline since boot:
+      uint16_t started = 0;
+      uint16_t missed = 0;
+
+    protected:
+      PersistentBlock<PreheatParams> persistent;
+      ExecutionContext *context = NULL;
+      boolean clockIsSet = false;
+      // minutes since midnight of "day 0" as of clockTick; advanced by the elapsed time so that it is not affected by
+      // the wrap-around of millis():
+      uint32_t clockMinutes = 0L;
+      TimeMillis clockTick = 0L;
+      // day number of the most recent start of each slot (prevents a second start for the same deadline):
+      uint16_t startedDay[PREHEAT_SLOTS];
+      uint16_t checkedDay[PREHEAT_SLOTS];
+      // slot being started (-1 -> none) and the next command of the start sequence:
+      int8_t activeSlot = -1;
+      uint8_t step = 0;
+      // beginning of the current cooling observation:
+      TimeMillis lossStart = 0L;
+      ACF_Temperature lossStartTemp = ACF_UNDEFINED_TEMPERATURE;
+
+      void advanceClock(TimeMillis now);
+      boolean sensorsOk();
+      void learnLosses(TimeMillis now, boolean heaterOn);
+  };
+
+#endif
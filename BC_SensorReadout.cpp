@@ -0,0 +1,127 @@
+#include "BC_SensorReadout.h"
+
+// #define DEBUG_SENSOR_READOUT
+
+void SensorReadout::init(ExecutionContext *context, OneWire *oneWire) {
+  this->context = context;
+  this->oneWire = oneWire;
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    previousStatus[i] = DS18B20_SENSOR_INITIALISING;
+  }
+}
+
+DS18B20_Sensor *SensorReadout::sensor(uint8_t i) {
+  return i == 0 ? &context->op->water : &context->op->ambient;
+}
+
+const uint8_t *SensorReadout::rom(uint8_t i) {
+  return i == 0 ? (const uint8_t *) &context->config->waterTempSensorId : (const uint8_t *) &context->config->ambientTempSensorId;
+}
+
+void SensorReadout::beforeReadout() {
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    previousStatus[i] = sensor(i)->sensorStatus;
+  }
+}
+
+void SensorReadout::afterReadout() {
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    DS18B20_Sensor *s = sensor(i);
+    if (previousStatus[i] != DS18B20_SENSOR_OK && previousStatus[i] != DS18B20_SENSOR_NOK) {
+      continue;
+    }
+    quality[i].readouts++;
+    if (s->sensorStatus == DS18B20_SENSOR_NOK) {
+      quality[i].failures++;
+      TimeMillis retryStart = millis();
+      boolean ok = reread(i);
+      TimeMillis retryMillis = millis() - retryStart;
+      if (retryMillis > quality[i].maxRetryMillis) {
+        quality[i].maxRetryMillis = retryMillis > 255 ? 255 : retryMillis;
+      }
+      if (! ok) {
+        continue;
+      }
+      quality[i].recovered++;
+      #ifdef DEBUG_SENSOR_READOUT
+        Serial.print(F("DEBUG_SENSOR_READOUT: sensor "));
+        Serial.print(i);
+        Serial.print(F(" recovered after "));
+        Serial.print(retryMillis);
+        Serial.println(F(" ms"));
+      #endif
+    }
+    #if SENSOR_FILTER != SENSOR_FILTER_NONE
+      if (s->sensorStatus == DS18B20_SENSOR_OK) {
+        s->currentTemp = filter(i, s->currentTemp);
+      }
+    #endif
+  }
+}
+
+boolean SensorReadout::reread(uint8_t i) {
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  for (uint8_t attempt = 0; attempt < SENSOR_READ_RETRIES; attempt++) {
+    if (ds18b20ReadScratchpad(oneWire, rom(i), scratchpad)) {
+      if (ds18b20PowerOnValue(scratchpad)) {
+        // the sensor has been reset since the conversion => there is no valid reading in this cycle:
+        return false;
+      }
+      DS18B20_Sensor *s = sensor(i);
+      s->currentTemp = ds18b20Temperature(scratchpad);
+      s->sensorStatus = DS18B20_SENSOR_OK;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Insertion sort of a copy, n <= SENSOR_FILTER_MAX_SAMPLES.
+ */
+static void sortTemperatures(const ACF_Temperature samples[], uint8_t n, ACF_Temperature sorted[]) {
+  for (uint8_t j = 0; j < n; j++) {
+    ACF_Temperature t = samples[j];
+    uint8_t k = j;
+    while (k > 0 && sorted[k - 1] > t) {
+      sorted[k] = sorted[k - 1];
+      k--;
+    }
+    sorted[k] = t;
+  }
+}
+
+ACF_Temperature medianTemperature(const ACF_Temperature samples[], uint8_t n) {
+  ACF_Temperature sorted[SENSOR_FILTER_MAX_SAMPLES];
+  sortTemperatures(samples, n, sorted);
+  return n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+ACF_Temperature trimmedMeanTemperature(const ACF_Temperature samples[], uint8_t n) {
+  ACF_Temperature sorted[SENSOR_FILTER_MAX_SAMPLES];
+  sortTemperatures(samples, n, sorted);
+  int32_t sum = 0;
+  for (uint8_t j = 1; j < n - 1; j++) {
+    sum += sorted[j];
+  }
+  return sum / (n - 2);
+}
+
+#if SENSOR_FILTER != SENSOR_FILTER_NONE
+  ACF_Temperature SensorReadout::filter(uint8_t i, ACF_Temperature temp) {
+    samples[i][nextSample[i]] = temp;
+    nextSample[i] = (nextSample[i] + 1) % SENSOR_FILTER_SAMPLES;
+    if (sampleCount[i] < SENSOR_FILTER_SAMPLES) {
+      sampleCount[i]++;
+    }
+    uint8_t n = sampleCount[i];
+    if (n < 3) {
+      return temp;
+    }
+    #if SENSOR_FILTER == SENSOR_FILTER_MEDIAN
+      return medianTemperature(samples[i], n);
+    #else
+      return trimmedMeanTemperature(samples[i], n);
+    #endif
+  }
+#endif
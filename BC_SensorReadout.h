@@ -0,0 +1,89 @@
+#ifndef BC_SENSOR_READOUT_H_INCLUDED
+  #define BC_SENSOR_READOUT_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include "BC_Sensors.h"
+
+  #define SENSOR_READ_RETRIES        2    // re-reads of the scratchpad after a failed regular readout
+  #define SENSOR_FILTER_NONE         0
+  #define SENSOR_FILTER_MEDIAN       1
+  #define SENSOR_FILTER_TRIMMED_MEAN 2    // mean without the lowest and the highest sample
+  #define SENSOR_FILTER              SENSOR_FILTER_NONE
+  #define SENSOR_FILTER_SAMPLES      5    // [cycles] window of the filter (max. SENSOR_FILTER_MAX_SAMPLES)
+  #define SENSOR_FILTER_MAX_SAMPLES  7
+
+  #define SENSOR_COUNT               2    // water, ambient
+
+  #if SENSOR_FILTER != SENSOR_FILTER_NONE && (SENSOR_FILTER_SAMPLES < 3 || SENSOR_FILTER_SAMPLES > SENSOR_FILTER_MAX_SAMPLES)
+    #error "SENSOR_FILTER_SAMPLES must be in 3..SENSOR_FILTER_MAX_SAMPLES"
+  #endif
+
+  /*
+   * Median and mean without the lowest and the highest sample of n (3..SENSOR_FILTER_MAX_SAMPLES) samples.
+   */
+  ACF_Temperature medianTemperature(const ACF_Temperature samples[], uint8_t n);
+  ACF_Temperature trimmedMeanTemperature(const ACF_Temperature samples[], uint8_t n);
+
+  /*
+   * Readout quality of one sensor since boot.
+   */
+  struct SensorQuality {
+    // regular readouts:
+    uint32_t readouts = 0L;
+    // readouts the DS18B20_Controller reported as failed (no response or CRC error):
+    uint16_t failures = 0;
+    // failures cleared by a re-read within the same cycle:
+    uint16_t recovered = 0;
+    // longest time [ms] spent re-reading after a failure:
+    uint8_t maxRetryMillis = 0;
+  };
+
+  /*
+   * Post-processing of the regular sensor readout, called around DS18B20_Controller::completeSensorReadout().
+   *
+   * Unless the sensor has been reset, the conversion result stays in its scratchpad, so a readout that failed on a
+   * bus glitch or a CRC error is repeated up to SENSOR_READ_RETRIES times before the sensor is left at
+   * DS18B20_SENSOR_NOK. A re-read returning the power-on value (85 °C) means the sensor was reset and holds no
+   * conversion result; the sensor is then left NOK. Sensors that were not OK or NOK before (initialising,
+   * ID undefined) are left to the library.
+   *
+   * With SENSOR_FILTER set, the reported temperature is the median (or trimmed mean) of the last
+   * SENSOR_FILTER_SAMPLES valid readouts. This delays the response to a real change by about half the window;
+   * overheating protection does not depend on it since the CutOutGuard reads the water sensor directly.
+   */
+  class SensorReadout {
+    public:
+      SensorReadout() {}
+
+      void init(ExecutionContext *context, OneWire *oneWire);
+
+      /*
+       * Call immediately before completeSensorReadout().
+       */
+      void beforeReadout();
+
+      /*
+       * Call immediately after completeSensorReadout().
+       */
+      void afterReadout();
+
+      SensorQuality quality[SENSOR_COUNT];
+
+    protected:
+      ExecutionContext *context = NULL;
+      OneWire *oneWire = NULL;
+      DS18B20_StatusID previousStatus[SENSOR_COUNT];
+      #if SENSOR_FILTER != SENSOR_FILTER_NONE
+        ACF_Temperature samples[SENSOR_COUNT][SENSOR_FILTER_SAMPLES];
+        uint8_t sampleCount[SENSOR_COUNT] = {0, 0};
+        uint8_t nextSample[SENSOR_COUNT] = {0, 0};
+
+        ACF_Temperature filter(uint8_t i, ACF_Temperature temp);
+      #endif
+
+      DS18B20_Sensor *sensor(uint8_t i);
+      const uint8_t *rom(uint8_t i);
+      boolean reread(uint8_t i);
+  };
+
+#endif
@@ -0,0 +1,72 @@
+#include "BC_Sensors.h"
+
+#define DS18B20_CMD_CONVERT_T         0x44
+#define DS18B20_CMD_WRITE_SCRATCHPAD  0x4E
+#define DS18B20_CMD_READ_SCRATCHPAD   0xBE
+
+#define SCRATCHPAD_TEMP_LSB   0
+#define SCRATCHPAD_TEMP_MSB   1
+#define SCRATCHPAD_TH         2
+#define SCRATCHPAD_TL         3
+#define SCRATCHPAD_CONFIG     4
+#define SCRATCHPAD_CRC        8
+
+TimeMillis ds18b20ConversionMillis(DS18B20_Resolution resolution) {
+  switch(resolution) {
+    case DS18B20_RESOLUTION_9_BIT:  return 94L;
+    case DS18B20_RESOLUTION_10_BIT: return 188L;
+    case DS18B20_RESOLUTION_11_BIT: return 375L;
+    default:                        return 750L;
+  }
+}
+
+boolean ds18b20StartConversion(OneWire *oneWire, const uint8_t rom[]) {
+  if (! oneWire->reset()) {
+    return false;
+  }
+  oneWire->select(rom);
+  oneWire->write(DS18B20_CMD_CONVERT_T);
+  return true;
+}
+
+boolean ds18b20ReadScratchpad(OneWire *oneWire, const uint8_t rom[], uint8_t buf[]) {
+  if (! oneWire->reset()) {
+    return false;
+  }
+  oneWire->select(rom);
+  oneWire->write(DS18B20_CMD_READ_SCRATCHPAD);
+  oneWire->read_bytes(buf, DS18B20_SCRATCHPAD_SIZE);
+  // an all-zero scratchpad has a valid CRC (0) but means the bus is shorted:
+  return buf[SCRATCHPAD_CONFIG] != 0 && OneWire::crc8(buf, SCRATCHPAD_CRC) == buf[SCRATCHPAD_CRC];
+}
+
+boolean ds18b20SetResolution(OneWire *oneWire, const uint8_t rom[], const uint8_t scratchpad[], DS18B20_Resolution resolution) {
+  if (! oneWire->reset()) {
+    return false;
+  }
+  oneWire->select(rom);
+  oneWire->write(DS18B20_CMD_WRITE_SCRATCHPAD);
+  oneWire->write(scratchpad[SCRATCHPAD_TH]);
+  oneWire->write(scratchpad[SCRATCHPAD_TL]);
+  oneWire->write((uint8_t) resolution);
+  return true;
+}
+
+#define DS18B20_POWER_ON_RAW 0x0550 // 85 °C
+
+boolean ds18b20PowerOnValue(const uint8_t scratchpad[]) {
+  return scratchpad[SCRATCHPAD_TEMP_MSB] == (DS18B20_POWER_ON_RAW >> 8) && scratchpad[SCRATCHPAD_TEMP_LSB] == (DS18B20_POWER_ON_RAW & 0xFF);
+}
+
+ACF_Temperature ds18b20Temperature(const uint8_t scratchpad[]) {
+  int16_t raw = (scratchpad[SCRATCHPAD_TEMP_MSB] << 8) | scratchpad[SCRATCHPAD_TEMP_LSB];
+  // the low bits are undefined at lower resolutions:
+  switch (scratchpad[SCRATCHPAD_CONFIG]) {
+    case DS18B20_RESOLUTION_9_BIT:  raw &= ~0x7; break;
+    case DS18B20_RESOLUTION_10_BIT: raw &= ~0x3; break;
+    case DS18B20_RESOLUTION_11_BIT: raw &= ~0x1; break;
+    default: break;
+  }
+  // raw is [°C / 16]:
+  return (ACF_Temperature) (((int32_t) raw * 100L) / 16L);
+}
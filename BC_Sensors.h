@@ -0,0 +1,57 @@
+#ifndef BC_SENSORS_H_INCLUDED
+  #define BC_SENSORS_H_INCLUDED
+
+  #include <ACF_DS18B20.h>
+  #include <OneWire.h>
+
+  /*
+   * Direct (ROM-addressed) access to a single DS18B20 sensor, bypassing the DS18B20_Controller.
+   *
+   * These helpers must only be used while the controller does NOT use the bus, i.e. outside
+   * the init/complete stages of the sensor-management cycle.
+   */
+
+  #define DS18B20_ROM_SIZE          8
+  #define DS18B20_SCRATCHPAD_SIZE   9
+
+  typedef enum {
+    DS18B20_RESOLUTION_9_BIT  = 0x1F,  //  93.75 ms, 0.5   °C
+    DS18B20_RESOLUTION_10_BIT = 0x3F,  // 187.5  ms, 0.25  °C
+    DS18B20_RESOLUTION_11_BIT = 0x5F,  // 375    ms, 0.125 °C
+    DS18B20_RESOLUTION_12_BIT = 0x7F   // 750    ms, 0.0625°C
+  } DS18B20_Resolution;
+
+  /*
+   * Returns the [ms] it takes the sensor to convert a temperature at the given resolution.
+   */
+  TimeMillis ds18b20ConversionMillis(DS18B20_Resolution resolution);
+
+  /*
+   * Starts a temperature conversion on the given sensor. Returns false if no device responded.
+   */
+  boolean ds18b20StartConversion(OneWire *oneWire, const uint8_t rom[]);
+
+  /*
+   * Reads the scratchpad of the given sensor into buf (DS18B20_SCRATCHPAD_SIZE bytes).
+   * Returns false if no device responded or if the CRC does not match.
+   */
+  boolean ds18b20ReadScratchpad(OneWire *oneWire, const uint8_t rom[], uint8_t buf[]);
+
+  /*
+   * Sets the conversion resolution in the scratchpad of the given sensor (not persisted to the sensor's EEPROM).
+   * The alarm bytes are taken from a previously read scratchpad.
+   */
+  boolean ds18b20SetResolution(OneWire *oneWire, const uint8_t rom[], const uint8_t scratchpad[], DS18B20_Resolution resolution);
+
+  /*
+   * True if the scratchpad holds the power-on reset value of the temperature register (85 °C). The value has a valid
+   * CRC, but it is not a conversion result if the sensor has been reset (e.g. by a bus glitch) since the conversion.
+   */
+  boolean ds18b20PowerOnValue(const uint8_t scratchpad[]);
+
+  /*
+   * Converts the raw temperature of a scratchpad to [°C * 100], taking the resolution into account.
+   */
+  ACF_Temperature ds18b20Temperature(const uint8_t scratchpad[]);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef BC_STATS_H_INCLUDED
+  #define BC_STATS_H_INCLUDED
+
+  #include <ACF_Types.h>
+
+  /*
+   * Runtime counters maintained by the controller and reported to the user (console: 'stat').
+   */
+  struct RuntimeStats {
+    // accumulated time [ms] the MCU spent in its sleep state since boot:
+    TimeMillis sleepMillis = 0L;
+    // number of times the MCU was put to sleep since boot:
+    uint32_t sleepCount = 0L;
+    // duration [ms] of the controller initialisation at boot:
+    TimeMillis initMillis = 0L;
+    // duration [ms] of restoring the log at boot (part of initMillis):
+    TimeMillis logInitMillis = 0L;
+    // time [ms] since boot when the first valid water temperature was read:
+    TimeMillis firstWaterTempMillis = 0L;
+    // the controller resumed the state it had before a brownout:
+    boolean warmRestart = false;
+  };
+
+#endif
@@ -3,6 +3,8 @@
 
   #include <BC_Control.h>
   #include <BC_State.h>
+  #include "BC_Runtime.h"
+  #include "BC_LogRecord.h"
 
   typedef enum {
     NOTIFY_NONE = 0x0,
@@ -14,6 +16,8 @@
     NOTIFY_AMBIENT_SENSOR = 0x20
   } NotifyPropertyEnum;
 
+  #define UI_STORE_SIZE 32 // [bytes] FRAM reserved for the UI's own persistent data
+  
   // bitwise "OR" of NotifyPropertyEnum literals:
   typedef uint16_t NotifyProperties;
   
@@ -38,8 +42,9 @@
     public:
       AbstractUI() : UserFeedback() {}
       
-      virtual void init(ExecutionContext *context) {
+      virtual void init(ExecutionContext *context, RuntimeContext *runtime) {
         this->context = context;
+        this->runtime = runtime;
       }
       
       /*
@@ -47,17 +52,45 @@
        */
       virtual void readUserRequest() { }
 
+      /*
+       * Returns true if user input is waiting to be read (used to end the controller's idle sleep early).
+       */
+      virtual boolean inputPending() { return false; }
+
+      /*
+       * Max. time [ms] the controller may sleep before the UI needs to be polled again.
+       */
+      virtual TimeMillis maxIdleMillis() { return 1000L; }
+
+      /*
+       * Called in every loop iteration, after the user request and the notifications have been processed:
+       * background work of the UI (e.g. sending queued notifications).
+       */
+      virtual void update() { }
+
       /*
        * Passes information in response to an explicit user request.
        */
       virtual void provideUserInfo(BoilerStateAutomaton *) {  }
     
-      virtual void notifyNewLogEntry(LogEntry) { }
+      /*
+       * Encodes the entry (see BC_LogRecord.h) and passes it to notifyNewLogRecord().
+       */
+      virtual void notifyNewLogEntry(LogEntry entry) {
+        uint8_t record[LOG_RECORD_MAX_SIZE];
+        notifyNewLogRecord(entry, record, encodeLogRecord(entry, record));
+      }
+
+      /*
+       * A new log entry and its encoded record (size 0: the entry can't be encoded).
+       */
+      virtual void notifyNewLogRecord(const LogEntry &, const uint8_t [], uint8_t) { }
       
       virtual void notifyStatusChange(StatusNotification *) { }
    
     protected:
       ExecutionContext *context;
+      RuntimeContext *runtime;
   };  
 
 #endif
@@ -1,4 +1,6 @@
+#include <stddef.h>
 #include "BC_UI_BLE.h"
+#include "BC_InputDecoder.h"
 
 #define DEBUG_BLE_MODULE false
 
@@ -6,7 +8,12 @@
 
 const char BC_DEVICE_NAME[] = "Boiler Controller";
 
-const uint8_t BC_CONTROLLER_SERVICE_UUID128[] = { 0x4c, 0xef, 0xdd, 0x58, 0xcb, 0x95, 0x44, 0x50, 0x90, 0xfb, 0xf4, 0x04, 0xdc, 0x20, 0x2f, 0x7c};
+// the last byte identifies the log record format (see BC_LogRecord.h):
+#ifdef LOG_RECORD_COMPACT
+  const uint8_t BC_CONTROLLER_SERVICE_UUID128[] = { 0x4c, 0xef, 0xdd, 0x58, 0xcb, 0x95, 0x44, 0x50, 0x90, 0xfb, 0xf4, 0x04, 0xdc, 0x20, 0x2f, 0x7d};
+#else
+  const uint8_t BC_CONTROLLER_SERVICE_UUID128[] = { 0x4c, 0xef, 0xdd, 0x58, 0xcb, 0x95, 0x44, 0x50, 0x90, 0xfb, 0xf4, 0x04, 0xdc, 0x20, 0x2f, 0x7c};
+#endif
 ///const uint16_t BC_CONTROLLER_SERVICE_SHORT_UUID16 = 0x4cef;
 
 const int8_t USER_CMD_MAX_SIZE = sizeof(T_UserCommand_ID) + USER_CMD_PARAMETER_MAX_SIZE;
@@ -26,9 +33,16 @@ const int8_t AMBIENT_SENSOR_CID = 8;
 
 /* Configuration Characteristics IDs */
 const int8_t TARGET_TEMP_CID = 9;
+const int8_t CONFIG_CID = 13;
+const int8_t CONFIG_BATCH_CID = 14;
 
  /* Log Characteristics IDs */
 const int8_t LOG_ENTRY_CID = 10;
+const int8_t ROLLUP_CID = 11;
+const int8_t FLIGHT_RECORDER_CID = 12;
+const int8_t ENERGY_CID = 15;
+
+static_assert(AMBIENT_SENSOR_CID <= BLE_MAX_STATUS_CID, "status CIDs exceed the notification queue");
   
 /* Status Characteristics */
 const char STR_SVC_CONTROLLER[]           PROGMEM = "Controller";
@@ -45,12 +59,146 @@ const char STR_TIME_TO_GO[]               PROGMEM = "Time to Go";
 
 /* Configuration Characteristics */
 const char STR_CHAR_TARGET_TEMP[]         PROGMEM = "Target Temp";
+const char STR_CHAR_CONFIG[]              PROGMEM = "Config";
+const char STR_CHAR_CONFIG_BATCH[]        PROGMEM = "Config Batch";
 
  /* Log Characteristics */
 const char STR_CHAR_LOG_ENTRY[]           PROGMEM = "Log Entry";
+const char STR_CHAR_ROLLUP[]              PROGMEM = "Rollup";
+const char STR_CHAR_FLIGHT_RECORDER[]     PROGMEM = "Flight Recorder";
+const char STR_CHAR_ENERGY[]              PROGMEM = "Energy";
+
+/*
+ * The result of a command written to USER_REQUEST_CID is notified on USER_REQUEST_CID (1 byte: 1 = ok, 0 = failed).
+ * Nothing is written to Serial, it may be used by the console's machine mode at the same time.
+ */
+#define USER_REQUEST_RESULT_SIZE 1
+
+/*
+ * Rollup record as read via ROLLUP_CID (max. 20 bytes per characteristic).
+ * The record is selected by writing { RollupPeriod (1 byte), age (2 bytes) } to ROLLUP_CID.
+ */
+struct BLERollupRecord {
+  uint16_t period;
+  ACF_Temperature waterMin;
+  ACF_Temperature waterMean;
+  ACF_Temperature waterMax;
+  ACF_Temperature ambientMin;
+  ACF_Temperature ambientMean;
+  ACF_Temperature ambientMax;
+  uint16_t heaterOnMinutes;
+  uint32_t energyWh;
+};
+
+#define ROLLUP_SELECTION_SIZE 3
+
+/*
+ * Chunk of the flight-recorder snapshot as read via FLIGHT_RECORDER_CID. The chunk is selected by writing the index
+ * of its first sample (2 bytes) to FLIGHT_RECORDER_CID; index FLIGHT_RECORDER_HEADER_INDEX selects the
+ * FlightSnapshotHeader instead (magic = 0 if there is no snapshot).
+ */
+#define FLIGHT_RECORDER_SAMPLES_PER_CHUNK 2
+#define FLIGHT_RECORDER_HEADER_INDEX 0xFFFF
+
+struct BLEFlightRecorderChunk {
+  uint16_t index;
+  union {
+    FlightSnapshotHeader header;
+    FlightSample samples[FLIGHT_RECORDER_SAMPLES_PER_CHUNK];
+  };
+} __attribute__((packed));
+
+/*
+ * The config params as read via CONFIG_CID in one transaction (without the sensor IDs, they don't fit into 20 bytes).
+ * Scaled as in ConfigBatchItem.
+ */
+struct BLEConfigBlock {
+  ACF_Temperature targetTemp;
+  ACF_Temperature heaterCutOutWaterTemp;
+  ACF_Temperature heaterBackOkWaterTemp;
+  ACF_Temperature logTempDelta;
+  uint16_t logTimeDelta;
+  int32_t tankCapacity;
+  int32_t heaterPower;
+} __attribute__((packed));
+
+/*
+ * A config batch is written to CONFIG_BATCH_CID in fragments of { flags (1 byte), ConfigBatchItem[0..3] }.
+ * The batch is applied when a fragment with CONFIG_BATCH_COMMIT is received; the ConfigBatchResult (1 byte) is then
+ * notified on CONFIG_BATCH_CID.
+ */
+#define CONFIG_BATCH_BEGIN  0x01 // discard previously received fragments
+#define CONFIG_BATCH_COMMIT 0x02 // apply the batch after this fragment
+#define CONFIG_BATCH_ITEMS_PER_FRAGMENT 3
+#define CONFIG_BATCH_FRAGMENT_MAX_SIZE (1 + CONFIG_BATCH_ITEMS_PER_FRAGMENT * sizeof(ConfigBatchItem))
+
+/*
+ * Energy counters as read via ENERGY_CID (see EnergyMeter); dayWh = BLE_ENERGY_DAY_UNKNOWN until the clock is set.
+ */
+#define BLE_ENERGY_DAY_UNKNOWN 0xFFFFFFFF
+
+struct BLEEnergyCounters {
+  uint32_t sessionWh;
+  uint32_t dayWh;
+  uint32_t lifetimeWh;
+} __attribute__((packed));
+
+/*
+ * GATT LAYOUT
+ */
+struct CharacteristicDefinition {
+  uint16_t uuid16;
+  uint8_t cid;
+  uint8_t properties;
+  uint8_t minLen;
+  uint8_t maxLen;
+  PGM_P description;
+};
+
+// in the order of the characteristic IDs (the module assigns them sequentially):
+const CharacteristicDefinition CHARACTERISTICS[] PROGMEM = {
+  // status
+  { 0x0001, STATE_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(T_State_ID), sizeof(T_State_ID), STR_CHAR_STATE },
+  { 0x0002, TIME_IN_STATE_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, STR_CHAR_TIME_IN_STATE },  // milliseconds
+  { 0x0003, TIME_HEATING_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, STR_CHAR_TIME_HEATING },  // milliseconds
+  { 0x0004, TIME_TO_GO_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, STR_TIME_TO_GO },
+  { 0x0005, ACCEPTED_USER_CMDS_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(UserCommands), sizeof(UserCommands), STR_CHAR_ACCEPTED_USER_CMDS },
+  { 0x0006, USER_REQUEST_CID, GATT_CHARS_PROPERTIES_WRITE | GATT_CHARS_PROPERTIES_NOTIFY, USER_REQUEST_RESULT_SIZE, USER_CMD_MAX_SIZE, STR_CHAR_USER_REQUEST },
+  { 0x0007, WATER_SENSOR_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, STR_CHAR_WATER_SENSOR },
+  { 0x0008, AMBIENT_SENSOR_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, STR_CHAR_AMBIENT_SENSOR },
+  // configuration
+  { 0x1000, TARGET_TEMP_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_WRITE, sizeof(ACF_Temperature), sizeof(ACF_Temperature), STR_CHAR_TARGET_TEMP },
+  // logs
+  { 0x2000, LOG_ENTRY_CID, GATT_CHARS_PROPERTIES_NOTIFY, LOG_RECORD_MIN_SIZE, LOG_RECORD_MAX_SIZE, STR_CHAR_LOG_ENTRY },
+  { 0x2001, ROLLUP_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_WRITE | GATT_CHARS_PROPERTIES_NOTIFY, ROLLUP_SELECTION_SIZE, sizeof(BLERollupRecord), STR_CHAR_ROLLUP },
+  { 0x2002, FLIGHT_RECORDER_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_WRITE | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(uint16_t), sizeof(BLEFlightRecorderChunk), STR_CHAR_FLIGHT_RECORDER },
+  // configuration (continued)
+  { 0x1001, CONFIG_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(BLEConfigBlock), sizeof(BLEConfigBlock), STR_CHAR_CONFIG },
+  { 0x1002, CONFIG_BATCH_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_WRITE | GATT_CHARS_PROPERTIES_NOTIFY, 1, CONFIG_BATCH_FRAGMENT_MAX_SIZE, STR_CHAR_CONFIG_BATCH },
+  // logs (continued)
+  { 0x2003, ENERGY_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(BLEEnergyCounters), sizeof(BLEEnergyCounters), STR_CHAR_ENERGY }
+};
+
+const uint8_t NUM_CHARACTERISTICS = sizeof(CHARACTERISTICS) / sizeof(CharacteristicDefinition);
+
+static_assert(sizeof(BLEConfigBlock) <= 20 && sizeof(BLEFlightRecorderChunk) <= 20 && CONFIG_BATCH_FRAGMENT_MAX_SIZE <= 20 && LOG_RECORD_MAX_SIZE <= 20, "BLE characteristic values are limited to 20 bytes");
+static_assert(PersistentBlock<BLELayoutInfo>::STORE_SIZE <= UI_STORE_SIZE, "BLE layout info exceeds the UI store");
 
 static ExecutionContext *bleContext;
 
+// rollup record selected by the central, to be provided outside the callback:
+static boolean rollupRequested = false;
+static RollupPeriod requestedRollupPeriod = ROLLUP_HOUR;
+static uint16_t requestedRollupAge = 0;
+
+// flight-recorder chunk selected by the central, to be provided outside the callback:
+static boolean flightRecorderRequested = false;
+static uint16_t requestedFlightRecorderIndex = 0;
+
+// config batch received from the central, to be applied outside the callback:
+static ConfigBatch configBatch;
+static boolean configBatchCommitted = false;
+
 /*
  * CALLBACKS
  */
@@ -66,7 +214,7 @@ void deviceDisconnected(void) {
   #endif
 }
 
-void bleGattRX(int32_t cid, uint8_t data[], uint16_t /*len*/) {
+void bleGattRX(int32_t cid, uint8_t data[], uint16_t len) {
   #ifdef DEBUG_BLE_UI
     Serial.print( F("DEBUG_BLE_UI: Callback for "));
     Serial.print(cid);
@@ -74,27 +222,61 @@ void bleGattRX(int32_t cid, uint8_t data[], uint16_t /*len*/) {
     Serial.print(len);
   #endif
 
+  // malformed writes are dropped as a whole:
   switch(cid) {
     case USER_REQUEST_CID: 
       {
-        T_UserCommand_ID cmd;
-        memcpy(&cmd, data, sizeof(T_UserCommand_ID));
-        #ifdef DEBUG_BLE_UI
-          Serial.print(", cmd = ");
-          Serial.println(cmd);
-        #endif
-        bleContext->op->request.setCommand(cmd);
+        UserCommandEnum cmd;
+        if (decodeUserCommand(data, len, USER_CMD_MAX_SIZE, cmd)) {
+          #ifdef DEBUG_BLE_UI
+            Serial.print(", cmd = ");
+            Serial.println(cmd);
+          #endif
+          bleContext->op->request.setCommand(cmd);
+        }
       }
       break;
     case TARGET_TEMP_CID:
       {
         ACF_Temperature targetTemp;
-        memcpy(&targetTemp, data, sizeof(ACF_Temperature));
-        #ifdef DEBUG_BLE_UI
-          Serial.print(", target Temp = ");
-          Serial.println(targetTemp);
-        #endif
-        bleContext->op->request.setParamValue(ConfigParam::TARGET_TEMP, (int32_t) targetTemp);
+        if (decodeTargetTemp(data, len, targetTemp)) {
+          #ifdef DEBUG_BLE_UI
+            Serial.print(", target Temp = ");
+            Serial.println(targetTemp);
+          #endif
+          bleContext->op->request.setParamValue(ConfigParam::TARGET_TEMP, (int32_t) targetTemp);
+        }
+      }
+      break;
+    case ROLLUP_CID:
+      if (decodeRollupSelection(data, len, requestedRollupPeriod, requestedRollupAge)) {
+        rollupRequested = true;
+      }
+      break;
+    case FLIGHT_RECORDER_CID:
+      if (decodeFlightRecorderSelection(data, len, requestedFlightRecorderIndex)) {
+        flightRecorderRequested = true;
+      }
+      break;
+    case CONFIG_BATCH_CID:
+      {
+        uint8_t flags;
+        ConfigBatchItem items[CONFIG_BATCH_ITEMS_PER_FRAGMENT];
+        int8_t count = decodeConfigBatchFragment(data, len, CONFIG_BATCH_ITEMS_PER_FRAGMENT, flags, items);
+        if (count < 0) {
+          // the batch is incomplete => reject it on commit:
+          configBatch.reject();
+          break;
+        }
+        if (flags & CONFIG_BATCH_BEGIN) {
+          configBatch.clear();
+        }
+        for (int8_t i = 0; i < count; i++) {
+          configBatch.add(items[i].id, items[i].value);
+        }
+        if (flags & CONFIG_BATCH_COMMIT) {
+          configBatchCommitted = true;
+        }
       }
       break;
     default:
@@ -132,13 +314,31 @@ void BLEUI::addCharacteristicChecked(const uint16_t uuid16, const uint8_t cid, u
   returnedCid == cid ? (void)0 : write_S_O_S((reinterpret_cast<const __FlashStringHelper *>(description)), line);
 }
 
-void BLEUI::init(ExecutionContext *context) {
-  AbstractUI::init(context);
-  
-  bleContext = context; // this is a sin ... but the callbacks are static and global
-  
-  ASSERT(ble.begin(DEBUG_BLE_MODULE), "Couldn't find Bluefruit, make sure it's in CMD mode & check wiring");
+uint32_t BLEUI::layoutHash() {
+  uint32_t hash = fnv1a((const uint8_t *) BC_DEVICE_NAME, strlen(BC_DEVICE_NAME));
+  hash = fnv1a(BC_CONTROLLER_SERVICE_UUID128, sizeof(BC_CONTROLLER_SERVICE_UUID128), hash);
+  for (uint8_t i = 0; i < NUM_CHARACTERISTICS; i++) {
+    CharacteristicDefinition c;
+    memcpy_P(&c, &CHARACTERISTICS[i], sizeof(CharacteristicDefinition));
+    // the description pointer is not part of the layout, its text is:
+    hash = fnv1a((const uint8_t *) &c, offsetof(CharacteristicDefinition, description), hash);
+    for (PGM_P p = c.description; pgm_read_byte(p) != '\0'; p++) {
+      uint8_t ch = pgm_read_byte(p);
+      hash = fnv1a(&ch, 1, hash);
+    }
+  }
+  return hash;
+}
+
+boolean BLEUI::moduleHasLayout() {
+  // the last characteristic only exists if the whole layout was built:
+  CharacteristicDefinition c;
+  memcpy_P(&c, &CHARACTERISTICS[NUM_CHARACTERISTICS - 1], sizeof(CharacteristicDefinition));
+  uint8_t buf[20];
+  return gatt.getChar(c.cid, buf, sizeof(buf)) >= c.minLen && c.minLen > 0;
+}
 
+void BLEUI::buildLayout() {
   /* Perform a factory reset to make sure everything is in a known state */
   ASSERT(ble.factoryReset(), "Could not factory reset");
 
@@ -158,22 +358,11 @@ void BLEUI::init(ExecutionContext *context) {
   // service
   addServiceChecked(BC_CONTROLLER_SERVICE_UUID128, CONTROLLER_SID, STR_SVC_CONTROLLER, __LINE__);
 
-  // status
-  addCharacteristicChecked(0x0001, STATE_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(T_State_ID), sizeof(T_State_ID), BLE_DATATYPE_AUTO, STR_CHAR_STATE, __LINE__);
-  addCharacteristicChecked(0x0002, TIME_IN_STATE_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, BLE_DATATYPE_AUTO, STR_CHAR_TIME_IN_STATE, __LINE__);  // milliseconds
-  addCharacteristicChecked(0x0003, TIME_HEATING_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, BLE_DATATYPE_AUTO, STR_CHAR_TIME_HEATING, __LINE__);  // milliseconds
-  addCharacteristicChecked(0x0004, TIME_TO_GO_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, BLE_DATATYPE_AUTO, STR_TIME_TO_GO, __LINE__);
-  addCharacteristicChecked(0x0005, ACCEPTED_USER_CMDS_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, sizeof(UserCommands), sizeof(UserCommands), BLE_DATATYPE_AUTO, STR_CHAR_ACCEPTED_USER_CMDS, __LINE__);
-  addCharacteristicChecked(0x0006, USER_REQUEST_CID, GATT_CHARS_PROPERTIES_WRITE,  sizeof(T_UserCommand_ID), USER_CMD_MAX_SIZE, BLE_DATATYPE_AUTO, STR_CHAR_USER_REQUEST, __LINE__); 
-  addCharacteristicChecked(0x0007, WATER_SENSOR_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, BLE_DATATYPE_AUTO, STR_CHAR_WATER_SENSOR, __LINE__);
-  addCharacteristicChecked(0x0008, AMBIENT_SENSOR_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_NOTIFY, 4, 4, BLE_DATATYPE_AUTO, STR_CHAR_AMBIENT_SENSOR, __LINE__);
-  
-  // configuration
-  addCharacteristicChecked(0x1000, TARGET_TEMP_CID, GATT_CHARS_PROPERTIES_READ | GATT_CHARS_PROPERTIES_WRITE,  sizeof(ACF_Temperature), sizeof(ACF_Temperature), BLE_DATATYPE_AUTO, STR_CHAR_TARGET_TEMP, __LINE__);
-  gatt.setChar(TARGET_TEMP_CID, context->config->targetTemp);
-  
-  // logs
-  addCharacteristicChecked(0x2000, LOG_ENTRY_CID, GATT_CHARS_PROPERTIES_NOTIFY, sizeof(LogEntry), sizeof(LogEntry), BLE_DATATYPE_AUTO, STR_CHAR_LOG_ENTRY, __LINE__);
+  for (uint8_t i = 0; i < NUM_CHARACTERISTICS; i++) {
+    CharacteristicDefinition c;
+    memcpy_P(&c, &CHARACTERISTICS[i], sizeof(CharacteristicDefinition));
+    addCharacteristicChecked(c.uuid16, c.cid, c.properties, c.minLen, c.maxLen, BLE_DATATYPE_AUTO, c.description, __LINE__);
+  }
   
   //uint8_t advdata[] { 0x02, 0x01, 0x06, 0x05, 0x02, 0x09, 0x18, 0x0a, 0x18 };
   uint8_t advdata[] { 0x02, 0x01, 0x06, 
@@ -183,15 +372,142 @@ void BLEUI::init(ExecutionContext *context) {
   
   /* Reset the device for the new service setting changes to take effect */
   ble.reset();
+}
+
+void BLEUI::init(ExecutionContext *context, RuntimeContext *runtime) {
+  AbstractUI::init(context, runtime);
+  layoutStore = PersistentBlock<BLELayoutInfo>(runtime->uiStore);
+  
+  bleContext = context; // this is a sin ... but the callbacks are static and global
+  
+  ASSERT(ble.begin(DEBUG_BLE_MODULE), "Couldn't find Bluefruit, make sure it's in CMD mode & check wiring");
+
+  uint32_t hash = layoutHash();
+  BLELayoutInfo stored;
+  if (layoutStore.load(stored) && stored.hash == hash && moduleHasLayout()) {
+    // the module still has our GATT layout from a previous boot => no factory reset and rebuild needed:
+    ble.echo(false);
+    #ifdef DEBUG_BLE_UI
+      Serial.println(F("DEBUG_BLE_UI: GATT layout reused"));
+    #endif
+  } else {
+    buildLayout();
+    stored.hash = hash;
+    layoutStore.save(stored);
+  }
+  
+  provideConfig();
   
   ble.setConnectCallback(deviceConnected);
   ble.setDisconnectCallback(deviceDisconnected);
   ble.setBleGattRxCallback(USER_REQUEST_CID, bleGattRX);
   ble.setBleGattRxCallback(TARGET_TEMP_CID, bleGattRX);
+  ble.setBleGattRxCallback(ROLLUP_CID, bleGattRX);
+  ble.setBleGattRxCallback(FLIGHT_RECORDER_CID, bleGattRX);
+  ble.setBleGattRxCallback(CONFIG_BATCH_CID, bleGattRX);
 }
 
 void BLEUI::readUserRequest() {
   ble.update(100); // ms
+  if (rollupRequested) {
+    rollupRequested = false;
+    provideRollup(requestedRollupPeriod, requestedRollupAge);
+  }
+  if (flightRecorderRequested) {
+    flightRecorderRequested = false;
+    provideFlightRecorderChunk(requestedFlightRecorderIndex);
+  }
+  if (configBatchCommitted) {
+    configBatchCommitted = false;
+    uint8_t result = configBatch.apply(context, runtime->automaton->acceptedUserCommands());
+    gatt.setChar(CONFIG_BATCH_CID, result);
+    if (result == CONFIG_BATCH_OK) {
+      configChanged = true;
+    }
+  }
+  if (configChanged) {
+    configChanged = false;
+    provideConfig();
+  }
+  EnergyCounters *energy = &runtime->energy->counters;
+  uint32_t dayWh = runtime->energy->dayKnown() ? energy->dayWh : BLE_ENERGY_DAY_UNKNOWN;
+  if (energy->sessionWh + dayWh + energy->lifetimeWh != providedEnergyWh && millis() - lastEnergyUpdate >= BLE_ENERGY_INTERVAL) {
+    provideEnergy();
+  }
+}
+
+void BLEUI::update() {
+  sendNotifications();
+}
+
+void BLEUI::provideFlightRecorderChunk(uint16_t index) {
+  FlightRecorder *recorder = runtime->flightRecorder;
+  BLEFlightRecorderChunk chunk;
+  memset(&chunk, 0, sizeof(BLEFlightRecorderChunk));
+  chunk.index = index;
+  
+  FlightSnapshotHeader header;
+  boolean valid = recorder->readSnapshotHeader(header);
+  if (index == FLIGHT_RECORDER_HEADER_INDEX) {
+    if (valid) {
+      chunk.header = header;
+    }
+  } else if (valid) {
+    for (uint8_t i = 0; i < FLIGHT_RECORDER_SAMPLES_PER_CHUNK && index + i < header.count; i++) {
+      recorder->readSnapshotSample(index + i, chunk.samples[i]);
+    }
+  }
+  gatt.setChar(FLIGHT_RECORDER_CID, (uint8_t *) &chunk, sizeof(BLEFlightRecorderChunk));
+}
+
+void BLEUI::provideConfig() {
+  ConfigParams *config = context->config;
+  BLEConfigBlock b;
+  b.targetTemp = config->targetTemp;
+  b.heaterCutOutWaterTemp = config->heaterCutOutWaterTemp;
+  b.heaterBackOkWaterTemp = config->heaterBackOkWaterTemp;
+  b.logTempDelta = config->logTempDelta;
+  b.logTimeDelta = config->logTimeDelta;
+  b.tankCapacity = tankCapacityMl(config);
+  b.heaterPower = heaterPowerW(config);
+  gatt.setChar(CONFIG_CID, (uint8_t *) &b, sizeof(BLEConfigBlock));
+  gatt.setChar(TARGET_TEMP_CID, config->targetTemp);
+}
+
+void BLEUI::provideEnergy() {
+  EnergyCounters *c = &runtime->energy->counters;
+  BLEEnergyCounters b = { c->sessionWh, runtime->energy->dayKnown() ? c->dayWh : BLE_ENERGY_DAY_UNKNOWN, c->lifetimeWh };
+  gatt.setChar(ENERGY_CID, (uint8_t *) &b, sizeof(BLEEnergyCounters));
+  providedEnergyWh = b.sessionWh + b.dayWh + b.lifetimeWh;
+  lastEnergyUpdate = millis();
+}
+
+void BLEUI::provideRollup(RollupPeriod period, uint16_t age) {
+  RollupRecord r;
+  BLERollupRecord b;
+  memset(&b, 0, sizeof(BLERollupRecord));
+  if (runtime->rollups->read(period, age, r)) {
+    b.period = r.period;
+    b.waterMin = r.waterMin;
+    b.waterMean = r.waterMean();
+    b.waterMax = r.waterMax;
+    b.ambientMin = r.ambientMin;
+    b.ambientMean = r.ambientMean();
+    b.ambientMax = r.ambientMax;
+    b.heaterOnMinutes = r.heaterOnSeconds / 60L;
+    b.energyWh = r.energy;
+  }
+  gatt.setChar(ROLLUP_CID, (uint8_t *) &b, sizeof(BLERollupRecord));
+}
+
+boolean BLEUI::inputPending() {
+  // the module raises IRQ when it has data for us:
+  return digitalRead(BLUEFRUIT_SPI_IRQ) == HIGH;
+}
+
+TimeMillis BLEUI::maxIdleMillis() {
+  // notifications left over from the last iteration are sent without delay:
+  return notificationsPending() ? 0L : BLE_POLL_INTERVAL;
 }
 
 
@@ -203,59 +519,146 @@ void BLEUI::provideUserInfo(BoilerStateAutomaton *automaton) {
 }
 
 void BLEUI::commandExecuted(boolean success) { 
-  /*
-   * ***** TODO ******
-   */
-  if (success) {
-    Serial.println(F("* command ok."));
-  } else {
-    Serial.println(F("* command failed."));
-  }
+  uint8_t ok = success;
+  gatt.setChar(USER_REQUEST_CID, ok);
 }
       
 void BLEUI::notifyStatusChange(StatusNotification *notification) {
-  boolean notified = false;
-
   if (notification->notifyProperties & NOTIFY_STATE) {
-    gatt.setChar(STATE_CID,notification->state.id());
-    gatt.setChar(ACCEPTED_USER_CMDS_CID, notification->acceptedUserCommands);
-    notified = true;
+    queueStatusValue(STATE_CID, notification->state.id());
+    queueStatusValue(ACCEPTED_USER_CMDS_CID, notification->acceptedUserCommands);
   }
   if (notification->notifyProperties & NOTIFY_TIME_IN_STATE) {
-    gatt.setChar(TIME_IN_STATE_CID, notification->timeInState);
-    notified = true;
+    queueStatusValue(TIME_IN_STATE_CID, notification->timeInState);
   }
   if (notification->notifyProperties & NOTIFY_TIME_HEATING) {
-    gatt.setChar(TIME_HEATING_CID, notification->heatingTime);
-    notified = true;
+    queueStatusValue(TIME_HEATING_CID, notification->heatingTime);
   }
   if (notification->notifyProperties & NOTIFY_TIME_TO_GO) {
-    gatt.setChar(TIME_TO_GO_CID, notification->timeToGo);
-    notified = true;
+    queueStatusValue(TIME_TO_GO_CID, notification->timeToGo);
   }
   if (notification->notifyProperties & NOTIFY_WATER_SENSOR) {
     int32_t waterSensor = notification->waterTemp;
     waterSensor = (waterSensor << 8) | notification->waterSensorStatus;
-    gatt.setChar(WATER_SENSOR_CID, waterSensor);
-    notified = true;
+    queueStatusValue(WATER_SENSOR_CID, waterSensor);
   }
   if (notification->notifyProperties & NOTIFY_AMBIENT_SENSOR) {
     int32_t ambientSensor = notification->ambientTemp;
     ambientSensor = (ambientSensor << 8) | notification->ambientSensorStatus;
-    gatt.setChar(AMBIENT_SENSOR_CID, ambientSensor);
-    notified = true;
+    queueStatusValue(AMBIENT_SENSOR_CID, ambientSensor);
   }
-  if (notified) {
-    #ifdef DEBUG_BLE_UI
-      Serial.println(F("DEBUG_BLE_UI: status notified via BLE"));
-    #endif
+}
+
+
+void BLEUI::notifyNewLogRecord(const LogEntry &entry, const uint8_t record[], uint8_t size) {
+  if (LogDataType(entry.type) == LogDataType::CONFIG) {
+    // changed by a user command (from any UI):
+    configChanged = true;
+  }
+  if (size == 0) {
+    return;
   }
+  if (logQueueCount == BLE_LOG_QUEUE_SIZE) {
+    // drop the oldest entry, it remains available via the log:
+    logQueueHead = (logQueueHead + 1) % BLE_LOG_QUEUE_SIZE;
+    logQueueCount--;
+    droppedLogEntries++;
+  }
+  uint8_t i = (logQueueHead + logQueueCount) % BLE_LOG_QUEUE_SIZE;
+  memcpy(logQueue[i], record, size);
+  logQueueSizes[i] = size;
+  logQueuedAt[i] = millis();
+  logQueueCount++;
 }
 
+void BLEUI::queueStatusValue(int8_t cid, int32_t value) {
+  uint16_t mask = 1 << cid;
+  if (!(pendingCIDs & mask)) {
+    pendingSince[cid] = millis();
+    pendingCIDs |= mask;
+  }
+  // coalesce: a value not yet sent is simply replaced by the latest one
+  pendingValues[cid] = value;
+}
 
-void BLEUI::notifyNewLogEntry(LogEntry entry) {
-  gatt.setChar(LOG_ENTRY_CID, (byte *) &entry, sizeof(LogEntry));
+boolean BLEUI::notificationsPending() {
+  return pendingCIDs != 0 || logQueueCount > 0;
+}
+
+void BLEUI::sendStatusValue(int8_t cid) {
+  // the characteristics have different sizes, send the value with the type it was declared with:
+  switch (cid) {
+    case STATE_CID:
+      gatt.setChar(cid, (T_State_ID) pendingValues[cid]);
+      break;
+    case ACCEPTED_USER_CMDS_CID:
+      gatt.setChar(cid, (UserCommands) pendingValues[cid]);
+      break;
+    default:
+      gatt.setChar(cid, pendingValues[cid]);
+      break;
+  }
+}
+
+/*
+ * Status characteristics in the order they are notified.
+ */
+const int8_t NOTIFICATION_PRIORITY[] PROGMEM = {
+  STATE_CID, ACCEPTED_USER_CMDS_CID,
+  WATER_SENSOR_CID, AMBIENT_SENSOR_CID,
+  TIME_TO_GO_CID, TIME_IN_STATE_CID, TIME_HEATING_CID
+};
+
+void BLEUI::sendNotifications() {
+  TimeMillis start = millis();
+  TimeMillis now = start;
+  uint8_t sent = 0;
+
+  // at least one notification is sent per iteration, whatever the link speed:
+  while (notificationsPending() && (sent == 0 || now - start < BLE_NOTIFICATION_BUDGET)) {
+    TimeMillis queuedAt;
+    int8_t cid = 0;
+    for (uint8_t i = 0; i < sizeof(NOTIFICATION_PRIORITY); i++) {
+      int8_t c = pgm_read_byte(&NOTIFICATION_PRIORITY[i]);
+      if (pendingCIDs & (1 << c)) {
+        cid = c;
+        break;
+      }
+    }
+    if (cid != 0) {
+      pendingCIDs &= ~(1 << cid);
+      queuedAt = pendingSince[cid];
+      sendStatusValue(cid);
+    } else {
+      queuedAt = logQueuedAt[logQueueHead];
+      gatt.setChar(LOG_ENTRY_CID, logQueue[logQueueHead], logQueueSizes[logQueueHead]);
+      logQueueHead = (logQueueHead + 1) % BLE_LOG_QUEUE_SIZE;
+      logQueueCount--;
+    }
+    sent++;
+    now = millis();
+    if (now - queuedAt > maxNotificationLatency) {
+      maxNotificationLatency = now - queuedAt;
+    }
+  }
+  if (now - start > maxDrainMillis) {
+    maxDrainMillis = now - start;
+  }
   #ifdef DEBUG_BLE_UI
-    Serial.println(F("DEBUG_BLE_UI: new log entry notified via BLE"));
+    if (sent > 0) {
+      Serial.print(F("DEBUG_BLE_UI: notified "));
+      Serial.print(sent);
+      Serial.print(F(" in "));
+      Serial.print(now - start);
+      Serial.print(F(" ms, queued "));
+      Serial.print(logQueueCount);
+      Serial.print(F(" log / dropped "));
+      Serial.print(droppedLogEntries);
+      Serial.print(F(", max latency "));
+      Serial.print(maxNotificationLatency);
+      Serial.print(F(" ms, max drain "));
+      Serial.print(maxDrainMillis);
+      Serial.println(F(" ms"));
+    }
   #endif
 }
@@ -2,6 +2,10 @@
   #define BC_UI_BLE_H_INCLUDED
 
   #include "BC_UI.h"
+  #include "BC_Persistent.h"
+  #include "BC_ConfigBatch.h"
+  #include "BC_Fixed.h"
+  #include "BC_LogRecord.h"
   #include <Adafruit_BLEGatt.h>
   #include <Adafruit_BluefruitLE_SPI.h>
   
@@ -17,15 +21,34 @@
   
   #define USER_CMD_PARAMETER_MAX_SIZE 8
   
+  /*
+   * Persisted description of the GATT layout built on the Bluefruit module.
+   */
+  struct BLELayoutInfo {
+    uint32_t hash;
+  };
+  
+  #define BLE_POLL_INTERVAL 250L // [ms] the module only reports GATT writes when polled
+  #define BLE_NOTIFICATION_BUDGET 30L // [ms] max. time spent sending notifications per loop iteration
+  #define BLE_LOG_QUEUE_SIZE 6 // log entries waiting to be notified; the oldest entry is dropped on overflow
+  #define BLE_MAX_STATUS_CID 8 // highest characteristic ID carrying a status value
+  #define BLE_ENERGY_INTERVAL 10000L // [ms] min. time between two updates of the energy counters
   
-  class BLEUI : public AbstractUI {
+  
+  class BLEUI final : public AbstractUI {
     public:
       
       BLEUI() : AbstractUI() { }
       
-      void init(ExecutionContext *context);
+      void init(ExecutionContext *context, RuntimeContext *runtime);
     
       void readUserRequest();
+
+      boolean inputPending();
+
+      TimeMillis maxIdleMillis();
+
+      void update();
       
       void commandExecuted(boolean success);
       
@@ -33,13 +56,54 @@
     
       void notifyStatusChange(StatusNotification *notification);
     
-      void notifyNewLogEntry(LogEntry entry);
+      void notifyNewLogRecord(const LogEntry &entry, const uint8_t record[], uint8_t size);
 
     protected:
       Adafruit_BluefruitLE_SPI ble = Adafruit_BluefruitLE_SPI(BLUEFRUIT_SPI_CS, BLUEFRUIT_SPI_IRQ, BLUEFRUIT_SPI_RST);
       Adafruit_BLEGatt gatt = Adafruit_BLEGatt(ble);
+      PersistentBlock<BLELayoutInfo> layoutStore = PersistentBlock<BLELayoutInfo>(NULL);
 
+      /*
+       * Hash over device name, service UUID and all characteristic definitions.
+       */
+      uint32_t layoutHash();
+      boolean moduleHasLayout();
+      void buildLayout();
       void setDeviceName(const char *name);
+      void provideConfig();
+      void provideEnergy();
+      void provideRollup(RollupPeriod period, uint16_t age);
+      void provideFlightRecorderChunk(uint16_t index);
+      /*
+       * Outgoing notifications: status values are coalesced per characteristic (only the latest value is sent),
+       * log entries are queued. The queue is drained by priority (state > sensors > timers > log) within
+       * BLE_NOTIFICATION_BUDGET per loop iteration, so a slow link cannot stall loop().
+       */
+      int32_t pendingValues[BLE_MAX_STATUS_CID + 1];
+      TimeMillis pendingSince[BLE_MAX_STATUS_CID + 1];
+      uint16_t pendingCIDs = 0;
+      // encoded log records (see BC_LogRecord.h) and their sizes:
+      uint8_t logQueue[BLE_LOG_QUEUE_SIZE][LOG_RECORD_MAX_SIZE];
+      uint8_t logQueueSizes[BLE_LOG_QUEUE_SIZE];
+      TimeMillis logQueuedAt[BLE_LOG_QUEUE_SIZE];
+      uint8_t logQueueHead = 0;
+      uint8_t logQueueCount = 0;
+      // number of log entries dropped because the queue was full:
+      uint16_t droppedLogEntries = 0;
+      // max. time [ms] between queueing and sending a notification:
+      TimeMillis maxNotificationLatency = 0L;
+      // sum of the energy counters [Wh] most recently provided (changes with every Wh and every reset) and when:
+      uint32_t providedEnergyWh = 0xFFFFFFFF;
+      TimeMillis lastEnergyUpdate = 0L;
+      // the config characteristics need to be refreshed:
+      boolean configChanged = false;
+      // max. time [ms] spent draining the queue in one loop iteration:
+      TimeMillis maxDrainMillis = 0L;
+
+      void queueStatusValue(int8_t cid, int32_t value);
+      boolean notificationsPending();
+      void sendStatusValue(int8_t cid);
+      void sendNotifications();
       //void addServiceChecked(const uint16_t uuid, const uint8_t sid, PGM_P description, uint16_t line);
       void addServiceChecked(const uint8_t uuid128[], const uint8_t sid, PGM_P description, uint16_t line);
       void addCharacteristicChecked(const uint16_t uuid16, const uint8_t cid, uint8_t properties, uint8_t min_len, uint8_t max_len, BLEDataType_t datatype, PGM_P description, uint16_t line);
@@ -1,5 +1,10 @@
 #include <BC_Config.h>
 #include "BC_UI_Console.h"
+#include "BC_ConfigBatch.h"
+#include "BC_Memory.h"
+#include "BC_Fixed.h"
+#include "BC_InputDecoder.h"
+#include "BC_LogRecord.h"
 
 // #define DEBUG_UI
 
@@ -31,22 +36,14 @@ const __FlashStringHelper *getConfigParamName(ConfigParam literal) {
   }
 }
 
-#define MAX_FLOAT_STR_LEN 20
-
-#if defined(ARDUINO_SAMD_ZERO) || defined(ARDUINO_SAMD_MKR1000)
-// dtostrf is missing from AVR library for SAMD ...
-// see https://github.com/adafruit/Adafruit_MQTT_Library/blob/master/Adafruit_MQTT.cpp
-static char *dtostrf (double val, signed char width, unsigned char prec, char *sout) {
-  char fmt[20];
-  sprintf(fmt, "%%%d.%df", width, prec);
-  sprintf(sout, fmt, val);
-  return sout;
-}
-#endif
-
-char *formatFloat(float f, char s[]) {
-  dtostrf((double)f, 6, 2, s); 
-  return s;
+const __FlashStringHelper *getHeaterControlParamName(uint8_t id) {
+  switch(id) {
+    case HEATER_CONTROL_PARAM_MODE: return F("Heater Control (0=thresh, 1=time-prop)");
+    case HEATER_CONTROL_PARAM_WINDOW: return F("Heater Window [s]");
+    case HEATER_CONTROL_PARAM_KP: return F("Heater Kp [per mille / C]");
+    case HEATER_CONTROL_PARAM_KI: return F("Heater Ki [per mille / C min]");
+    default: return F("Undef");
+  }
 }
 
 
@@ -74,9 +71,9 @@ char *getConfigParamValue(ConfigParams *all, ConfigParam p, char buf[]) {
     case ConfigParam::LOG_TIME_DELTA:
       return formatInt(all->logTimeDelta, buf);
     case ConfigParam::TANK_CAPACITY:
-      return formatFloat(all->tankCapacity, buf);
+      return formatFixed(tankCapacityMl(all), 0, buf);
     case ConfigParam::HEATER_POWER:
-      return formatFloat(all->heaterPower, buf);
+      return formatFixed(heaterPowerW(all), 0, buf);
     default: 
       buf[0] = '\0';
       return buf;
@@ -90,7 +87,7 @@ char *getConfigParamValue(ConfigParams *all, ConfigParam p, char buf[]) {
 const char STR_CMD_INFO_HELP[]        PROGMEM = "help";
 const char STR_CMD_INFO_STAT[]        PROGMEM = "stat";
 const char STR_CMD_INFO_CONFIG[]      PROGMEM = "config";
-const char STR_CMD_INFO_LOG[]         PROGMEM = "log";        // + <param>
+const char STR_CMD_INFO_LOG[]         PROGMEM = "log";        // + [<type>] <param>
 const char STR_CMD_CONFIG_SET_VALUE[] PROGMEM = "config set"; // + <id> <value>
 const char STR_CMD_CONFIG_SWAP_IDS[]  PROGMEM = "config swqp ids";
 const char STR_CMD_CONFIG_CLEAR_IDS[] PROGMEM = "config clr ids";
@@ -104,6 +101,21 @@ const char STR_CMD_HEAT_RESET[]       PROGMEM = "heat reset";
 
 #define MAX_CMD_NAME_LEN 15  // not including trailing \0
 
+/*
+ * LOCAL COMMANDS (handled by the console, not by the automaton)
+ */
+const char STR_CMD_ROLLUP[]           PROGMEM = "rollup";     // + [<result-lines>]
+const char STR_CMD_ROLLUP_DAY[]       PROGMEM = "rollup day"; // + [<result-lines>]
+const char STR_CMD_FDR[]              PROGMEM = "fdr";
+const char STR_CMD_FDR_DUMP[]         PROGMEM = "fdr dump";
+const char STR_CMD_MACH[]             PROGMEM = "mach";
+const char STR_CMD_WATCH[]            PROGMEM = "watch";      // + [<ms>]
+const char STR_CMD_WATCH_OFF[]        PROGMEM = "watch off";
+const char STR_CMD_TIME[]             PROGMEM = "time";       // + [HH:MM]
+const char STR_CMD_SCHED[]            PROGMEM = "sched";
+const char STR_CMD_SCHED_SET[]        PROGMEM = "sched set";  // + <slot> <HH:MM> <temp>
+const char STR_CMD_SCHED_CLR[]        PROGMEM = "sched clr";  // + <slot>
+
 PGM_P getUserCommandNamePtr(UserCommandEnum literal) {
   switch(literal) {
     case CMD_NONE: return STR_NONE;
@@ -130,6 +142,27 @@ char *getUserCommandName(UserCommandEnum literal, char buf[]) {
   return buf;
 }
 
+/*
+ * LOG DATA TYPES (filter of the 'log' command)
+ */
+const char STR_LOG_TYPE_MESSAGE[] PROGMEM = "msg";
+const char STR_LOG_TYPE_VALUES[]  PROGMEM = "values";
+const char STR_LOG_TYPE_STATE[]   PROGMEM = "state";
+const char STR_LOG_TYPE_CONFIG[]  PROGMEM = "config";
+
+int8_t parseLogDataType(const char name[]) {
+  if (!strcmp_P(name, STR_LOG_TYPE_MESSAGE)) {
+    return (int8_t) LogDataType::MESSAGE;
+  } else if (!strcmp_P(name, STR_LOG_TYPE_VALUES)) {
+    return (int8_t) LogDataType::VALUES;
+  } else if (!strcmp_P(name, STR_LOG_TYPE_STATE)) {
+    return (int8_t) LogDataType::STATE;
+  } else if (!strcmp_P(name, STR_LOG_TYPE_CONFIG)) {
+    return (int8_t) LogDataType::CONFIG;
+  }
+  return -1;
+}
+
 /*
  * SENSOR STATUS
  */
@@ -225,7 +258,7 @@ void printError(const __FlashStringHelper *err) {
 char *readCommandLine(char buf[]) {
   uint8_t count = 0;
   do {
-    count += Serial.readBytes(&buf[count], CMD_LINE_BUF_SIZE);
+    count += Serial.readBytes(&buf[count], CMD_LINE_BUF_SIZE - count);
     delay(2);
   } while( (count < CMD_LINE_BUF_SIZE) && Serial.available());
   #ifdef DEBUG_UI
@@ -235,29 +268,22 @@ char *readCommandLine(char buf[]) {
     Serial.println(count);
   #endif
 
-  // remove multiple consecutive spaces
-  uint8_t len = 0;
-  boolean prevSpace = false;
-  for (uint8_t i = 0; i< count; i++) {
-     if (isspace(buf[i]) && prevSpace) {
-        // skip
-     } else {
-      buf[len++] = buf[i];
-     }
-     prevSpace = isspace(buf[i]);
-  }
-  buf[len] = '\0';
-  
-  // convert to lower case:
-  char *lower = strlwr(buf);
-  return lower;
+  normalizeCommandLine(buf, count);
+  return buf;
 }
 
       
 void ConsoleUI::readUserRequest() {
+  if (watchInterval > 0 && !machineMode) {
+    checkWatchLine();
+  }
   if( ! Serial.available()) {
     return;
   }
+  if (machineMode) {
+    readMachineRequest();
+    return;
+  }
   delay(2);
   
   char buf[CMD_LINE_BUF_SIZE+1];
@@ -267,17 +293,23 @@ void ConsoleUI::readUserRequest() {
   
   UserRequest *request = &(context->op->request);
   
-  // count the request characters up to the trailing numeric arguments (if any):
-  uint8_t cmdLen = strspn(cmdLine, CMD_CHARS);
-  
-  // set request args as anything following the command:
-  char *args = &cmdLine[cmdLen];
+  // split into the command and the trailing numeric arguments (if any):
+  char *args;
+  uint8_t cmdLen = splitCommandLine(cmdLine, CMD_CHARS, &args);
+  if (cmdLen == 0) {
+    printError(F("Illegal command (try: help or ?)"));
+    return;
+  }
   
-  // ignore trailing space (if any):
-  if (isspace(cmdLine[cmdLen - 1])) {
-    cmdLen--;
+  // 'log <type>' => filtered log request:
+  logFilter = -1;
+  if (cmdLen > 4 && !strncmp_P(cmdLine, STR_CMD_INFO_LOG, 3) && cmdLine[3] == ' ') {
+    logFilter = parseLogDataType(&cmdLine[4]);
+    if (logFilter >= 0) {
+      cmdLen = 3;
+      cmdLine[cmdLen] = '\0';
+    }
   }
-  cmdLine[cmdLen] = '\0';
   request->command = parseUserCommand(cmdLine, cmdLen);  
   
   #ifdef DEBUG_UI
@@ -291,41 +323,56 @@ void ConsoleUI::readUserRequest() {
     Serial.println(F("'"));
   #endif
   if (request->command == CMD_NONE) {
+    if (handleLocalCommand(cmdLine, args)) {
+      return;
+    }
     printError(F("Illegal command (try: help or ?)"));
   }
 
   // parse command args where applicable:
   if (request->command == CMD_CONFIG_SET_VALUE) {
-    // determine length of config param id (=number):
-    uint8_t len = strspn(args, INT_CHARS);
-    args[len] = '\0';
-    T_UserCommand_ID id = atoi(args);
-    char *paramValue = &args[len+1];
-
-    if (id < NUM_CONFIG_PARAMS) {
+    int32_t id;
+    char *paramValue;
+    if (! parseIntArg(args, 0, UINT8_MAX, id, &paramValue)) {
+      printError(F("Unknown config parameter"));
+      request->command = CMD_NONE;
+      
+    } else if (id < NUM_CONFIG_PARAMS) {
       ConfigParam param = ConfigParam(id);
       ConfigParamType type = context->config->paramType(param);
       request->param = param;
-      if (type == ConfigParamType::TEMPERATURE) {
-        request->intValue = atoi(paramValue);
-      } else if (type == ConfigParamType::FLOAT) {
-        request->floatValue = atof(paramValue);
+      int32_t value;
+      boolean valid = parseIntArg(paramValue, INT32_MIN, INT32_MAX, value) && configValueInRange(id, value);
+      if (valid && type == ConfigParamType::TEMPERATURE) {
+        request->intValue = value;
+      } else if (valid && type == ConfigParamType::FLOAT) {
+        // the float params (tank capacity [ml], heater power [W]) are whole numbers => no atof needed:
+        request->floatValue = value;
       } else {
         printError(F("Illegal value"));
+        request->command = CMD_NONE;
       }
       
+    } else if (id >= HEATER_CONTROL_PARAM_BASE_ID && id < HEATER_CONTROL_PARAM_BASE_ID + NUM_HEATER_CONTROL_PARAMS) {
+      // heater-control params are not known to the automaton => apply directly (the value range is checked there):
+      int32_t value;
+      commandExecuted(parseIntArg(paramValue, INT32_MIN, INT32_MAX, value)
+        && runtime->heaterControl->setParam(id - HEATER_CONTROL_PARAM_BASE_ID, value));
+      request->command = CMD_NONE;
+      
     } else {
       printError(F("Unknown config parameter"));
+      request->command = CMD_NONE;
     }
     
   } else if (request->command == CMD_INFO_LOG) {
-    // determine length of number of log entries to return (if any):
-    request->intValue = -1L;
-    uint8_t len = strspn(args, INT_CHARS);
-    if (len > 0) {
-      args[len] = '\0';
-      request->intValue = atoi(args);
+    // number of log entries to return (if any):
+    int32_t n = -1L;
+    if (*args != '\0' && ! parseIntArg(args, 0L, UINT16_MAX, n)) {
+      printError(F("Illegal value"));
+      request->command = CMD_NONE;
     }
+    request->intValue = n;
   }
   
   #ifdef DEBUG_UI
@@ -343,11 +390,60 @@ void ConsoleUI::readUserRequest() {
   #endif
 }
 
+boolean ConsoleUI::inputPending() {
+  return Serial.available() > 0;
+}
+
+boolean ConsoleUI::handleLocalCommand(const char cmd[], char args[]) {
+  if (handleScheduleCommand(cmd, args)) {
+    return true;
+  }
+  int32_t n = -1L;
+  if (*args != '\0' && ! parseIntArg(args, 0L, INT16_MAX, n)) {
+    printError(F("Illegal value"));
+    return true;
+  }
+  
+  if (!strcmp_P(cmd, STR_CMD_ROLLUP)) {
+    printRollups(ROLLUP_HOUR, n < 0 ? 5 : n);
+  } else if (!strcmp_P(cmd, STR_CMD_ROLLUP_DAY)) {
+    printRollups(ROLLUP_DAY, n < 0 ? 7 : n);
+  } else if (!strcmp_P(cmd, STR_CMD_FDR)) {
+    printFlightRecorder();
+  } else if (!strcmp_P(cmd, STR_CMD_FDR_DUMP)) {
+    dumpFlightRecorder();
+    return true;
+  } else if (!strcmp_P(cmd, STR_CMD_WATCH)) {
+    watchInterval = n < WATCH_MIN_INTERVAL ? (n < 0 ? WATCH_DEFAULT_INTERVAL : WATCH_MIN_INTERVAL) : n;
+    // the first line contains all values:
+    watchPending = NOTIFY_STATE | NOTIFY_TIME_TO_GO | NOTIFY_WATER_SENSOR | NOTIFY_AMBIENT_SENSOR;
+    watchHeater = -1;
+    lastWatchLine = millis() - watchInterval;
+    Serial.println(F("time[ms],state,water[1/100 C],ambient[1/100 C],heater,time to go[s]"));
+    return true;
+  } else if (!strcmp_P(cmd, STR_CMD_WATCH_OFF)) {
+    watchInterval = 0L;
+  } else if (!strcmp_P(cmd, STR_CMD_MACH)) {
+    Serial.println(F("* machine mode"));
+    machineMode = true;
+    return true;
+  } else {
+    return false;
+  }
+  Serial.println();
+  return true;
+}
+
 /*
  * COMMAND EXECUTION
  */
 
 void ConsoleUI::commandExecuted(boolean success) {
+  if (machineMode) {
+    uint8_t ok = success;
+    writeFrame(FRAME_ACK, &ok, sizeof(ok));
+    return;
+  }
   if (success) {
     Serial.println(F("* command ok."));
   } else {
@@ -411,7 +507,7 @@ void printLogEntry(LogEntry *e) {
         ConfigParam param = ConfigParam(data.id);
         Serial.print(getConfigParamName(param));
         Serial.print(F(" = "));
-        Serial.println(formatFloat(data.newValue, buf));  // line uses 1 KByte without the formatFloat!
+        Serial.println(formatFixed(logConfigValue(data), 2, buf));
       }
       break;
       
@@ -420,6 +516,266 @@ void printLogEntry(LogEntry *e) {
       printError(F("Unsupported LogTypeID"));
   }
 }
+
+/*
+ * Splits s at the first blank; returns the remainder (empty if there is none).
+ */
+static char *splitToken(char *s) {
+  char *blank = strchr(s, ' ');
+  if (blank == NULL) {
+    return s + strlen(s);
+  }
+  *blank = '\0';
+  return blank + 1;
+}
+
+static boolean parseTimeOfDay(const char *s, uint16_t &minuteOfDay) {
+  uint8_t hourLen = strspn(s, INT_CHARS);
+  if (hourLen == 0 || hourLen > 2 || s[hourLen] != ':') {
+    return false;
+  }
+  const char *m = &s[hourLen + 1];
+  if (strspn(m, INT_CHARS) != 2 || m[2] != '\0') {
+    return false;
+  }
+  uint8_t hour = atoi(s);
+  uint8_t minute = atoi(m);
+  if (hour > 23 || minute > 59) {
+    return false;
+  }
+  minuteOfDay = hour * 60 + minute;
+  return true;
+}
+
+static char *formatTimeOfDay(uint16_t minuteOfDay, char buf[]) {
+  uint8_t hour = minuteOfDay / 60;
+  uint8_t minute = minuteOfDay % 60;
+  buf[0] = '0' + hour / 10;
+  buf[1] = '0' + hour % 10;
+  buf[2] = ':';
+  buf[3] = '0' + minute / 10;
+  buf[4] = '0' + minute % 10;
+  buf[5] = '\0';
+  return buf;
+}
+
+boolean ConsoleUI::handleScheduleCommand(const char cmd[], char args[]) {
+  PreheatScheduler *scheduler = runtime->scheduler;
+  
+  if (!strcmp_P(cmd, STR_CMD_TIME)) {
+    uint16_t minuteOfDay;
+    if (args[0] == '\0') {
+      // just print the schedule
+    } else if (parseTimeOfDay(args, minuteOfDay)) {
+      scheduler->setClock(millis(), minuteOfDay);
+    } else {
+      printError(F("Illegal time (HH:MM)"));
+      return true;
+    }
+    printSchedule();
+    
+  } else if (!strcmp_P(cmd, STR_CMD_SCHED)) {
+    printSchedule();
+    
+  } else if (!strcmp_P(cmd, STR_CMD_SCHED_SET)) {
+    char *time = splitToken(args);
+    char *temp = splitToken(time);
+    splitToken(temp);
+    uint16_t minuteOfDay;
+    int32_t slot;
+    int32_t targetTemp;
+    if (!parseIntArg(args, 1, PREHEAT_SLOTS, slot) || !parseTimeOfDay(time, minuteOfDay) || !parseFixed(temp, 2, 0, INT16_MAX, targetTemp)
+        || !scheduler->setSlot(slot - 1, minuteOfDay, targetTemp)) {
+      printError(F("Illegal schedule (slot 1-4, HH:MM, temp below cut-out)"));
+      return true;
+    }
+    printSchedule();
+    
+  } else if (!strcmp_P(cmd, STR_CMD_SCHED_CLR)) {
+    int32_t slot;
+    if (!parseIntArg(args, 1, PREHEAT_SLOTS, slot) || !scheduler->setSlot(slot - 1, PREHEAT_SLOT_UNUSED, 0)) {
+      printError(F("Illegal slot"));
+      return true;
+    }
+    printSchedule();
+    
+  } else {
+    return false;
+  }
+  Serial.println();
+  return true;
+}
+
+void ConsoleUI::printSchedule() {
+  PreheatScheduler *scheduler = runtime->scheduler;
+  char buf[16];
+  
+  Serial.print(F("Time: "));
+  if (scheduler->clockSet()) {
+    Serial.println(formatTimeOfDay(scheduler->minuteOfDay(millis()), buf));
+  } else {
+    Serial.println(F("not set (schedule inactive)"));
+  }
+  Serial.print(F("Heat loss rate [1/100'000 h]: "));
+  Serial.print(scheduler->params.lossRate);
+  Serial.print(F(", preheats started: "));
+  Serial.print(scheduler->started);
+  Serial.print(F(", targets missed: "));
+  Serial.println(scheduler->missed);
+  
+  for (uint8_t i = 0; i < PREHEAT_SLOTS; i++) {
+    PreheatSlot *slot = &scheduler->params.slots[i];
+    Serial.print(i + 1);
+    Serial.print(F(" - "));
+    if (slot->readyMinute == PREHEAT_SLOT_UNUSED) {
+      Serial.println('-');
+      continue;
+    }
+    Serial.print(F("ready by "));
+    Serial.print(formatTimeOfDay(slot->readyMinute, buf));
+    Serial.print(F(" at "));
+    Serial.print(formatTemperature(slot->targetTemp, buf));
+    TimeSeconds heatingTime = scheduler->estimatedHeatingTime(slot->targetTemp);
+    if (heatingTime != UNDEFINED_TIME_SECONDS) {
+      Serial.print(F(", heating time [min]: "));
+      Serial.print(heatingTime / 60L);
+    }
+    Serial.println();
+  }
+}
+
+void printRollupTemperatures(ACF_Temperature min, ACF_Temperature mean, ACF_Temperature max, char buf[]) {
+  Serial.print(formatTemperature(min, buf));
+  Serial.print('/');
+  Serial.print(formatTemperature(mean, buf));
+  Serial.print('/');
+  Serial.print(formatTemperature(max, buf));
+}
+
+void ConsoleUI::printRollups(RollupPeriod period, uint16_t entriesToReturn) {
+  Rollups *rollups = runtime->rollups;
+  uint16_t available = rollups->available(period);
+  if (entriesToReturn == 0 || entriesToReturn > available) {
+    entriesToReturn = available;
+  }
+  Serial.print(period == ROLLUP_HOUR ? F("Hour") : F("Day"));
+  Serial.println(F("  water min/mean/max  ambient min/mean/max  heater [s]  energy [Wh]"));
+  
+  char buf[16];
+  RollupRecord r;
+  for (uint16_t age = 0; age < entriesToReturn; age++) {
+    if (! rollups->read(period, age, r)) {
+      break;
+    }
+    Serial.print(r.period);
+    Serial.print(F("  "));
+    printRollupTemperatures(r.waterMin, r.waterMean(), r.waterMax, buf);
+    Serial.print(F("  "));
+    printRollupTemperatures(r.ambientMin, r.ambientMean(), r.ambientMax, buf);
+    Serial.print(F("  "));
+    Serial.print(r.heaterOnSeconds);
+    Serial.print(F("  "));
+    Serial.println(r.energy);
+  }
+}
+
+const __FlashStringHelper *getFaultName(T_Fault_ID fault) {
+  switch(fault) {
+    case FAULT_WATER_SENSOR_NOK:   return F("Water sensor NOK");
+    case FAULT_AMBIENT_SENSOR_NOK: return F("Ambient sensor NOK");
+    case FAULT_HEATER_CUT_OUT:     return F("Heater cut-out");
+    default: return FP(STR_ILLEGAL);
+  }
+}
+
+void ConsoleUI::printFlightRecorder() {
+  FlightRecorder *recorder = runtime->flightRecorder;
+  Serial.print(F("Samples recorded: "));
+  Serial.println(recorder->recorded);
+  
+  FlightSnapshotHeader header;
+  if (! recorder->readSnapshotHeader(header)) {
+    Serial.println(F("No snapshot."));
+    return;
+  }
+  Serial.print(F("Snapshot: "));
+  Serial.print(getFaultName(header.fault));
+  Serial.print(F(" at [s] "));
+  Serial.println(header.time / 1000L);
+  Serial.println(F("Time [s]  state  water  ambient  heater"));
+  
+  char buf[16];
+  FlightSample sample;
+  for (uint8_t i = 0; i < header.count; i++) {
+    recorder->readSnapshotSample(i, sample);
+    Serial.print(sample.time);
+    Serial.print(F("  "));
+    Serial.print(sample.state);
+    Serial.print(F("  "));
+    Serial.print(getSensorStatusName((DS18B20_StatusEnum) (sample.flags & 0x7)));
+    Serial.print(' ');
+    Serial.print(formatTemperature(sample.water, buf));
+    Serial.print(F("  "));
+    Serial.print(getSensorStatusName((DS18B20_StatusEnum) ((sample.flags >> 3) & 0x7)));
+    Serial.print(' ');
+    Serial.print(formatTemperature(sample.ambient, buf));
+    Serial.print(F("  "));
+    Serial.println(sample.flags & FLIGHT_SAMPLE_HEATER_ON ? 1 : 0);
+  }
+}
+
+/*
+ * Binary dump: "FDR", FlightSnapshotHeader, FlightSample * header.count (all little endian, as in memory).
+ * An empty header (magic = 0) is sent if there is no snapshot.
+ */
+void ConsoleUI::dumpFlightRecorder() {
+  FlightRecorder *recorder = runtime->flightRecorder;
+  FlightSnapshotHeader header;
+  if (! recorder->readSnapshotHeader(header)) {
+    memset(&header, 0, sizeof(FlightSnapshotHeader));
+  }
+  Serial.write((const uint8_t *) "FDR", 3);
+  Serial.write((const uint8_t *) &header, sizeof(FlightSnapshotHeader));
+  FlightSample sample;
+  for (uint8_t i = 0; i < header.count; i++) {
+    recorder->readSnapshotSample(i, sample);
+    Serial.write((const uint8_t *) &sample, sizeof(FlightSample));
+  }
+  Serial.flush();
+}
+
+uint16_t ConsoleUI::printFilteredLog(LogDataType type, uint16_t entriesToReturn) {
+  LogTypeIndex *index = runtime->logIndex;
+  uint32_t indexBytesRead = index->bytesRead;
+  uint16_t logEntriesRead = 0;
+  uint16_t entriesOutput = 0;
+  LogEntry e;
+  
+  if (LogTypeIndex::isIndexed(type)) {
+    // only the entries of the type are read from the log:
+    index->readMostRecentEntries(type, entriesToReturn);
+    while (index->nextEntry(e)) {
+      outputLogEntry(&e);
+      entriesOutput++;
+    }
+    
+  } else {
+    // read only as many entries as it takes to include the requested VALUES entries:
+    context->log->readMostRecentLogEntries(index->valuesLogSpan(entriesToReturn));
+    while (context->log->nextLogEntry(e)) {
+      logEntriesRead++;
+      if (LogDataType(e.type) == type) {
+        outputLogEntry(&e);
+        entriesOutput++;
+      }
+    }
+  }
+  if (!machineMode) {
+    Serial.print(F("FRAM bytes read: "));
+    Serial.println(index->bytesRead - indexBytesRead + logEntriesRead * sizeof(LogEntry));
+  }
+  return entriesOutput;
+}
       
 void ConsoleUI::provideUserInfo(BoilerStateAutomaton *automaton) {
   UserCommandEnum request = context->op->request.command;
@@ -427,6 +783,10 @@ void ConsoleUI::provideUserInfo(BoilerStateAutomaton *automaton) {
     Serial.print(F("DEBUG_UI: processing info request: 0x"));
     Serial.println(request, HEX);
   #endif
+  if (machineMode) {
+    provideMachineInfo(automaton);
+    return;
+  }
   
   char buf[32];
   OperationalParams *op = context->op;
@@ -442,13 +802,32 @@ void ConsoleUI::provideUserInfo(BoilerStateAutomaton *automaton) {
         if (cmd == CMD_CONFIG_SET_VALUE) {
           Serial.print(F(" <param-id> <value>"));
         } else if (cmd == CMD_INFO_LOG) {
-          Serial.print(F(" [<result-lines>]   (0 -> all)"));
+          Serial.print(F(" [msg|values|state|config] [<result-lines>]   (0 -> all)"));
         }
         Serial.println();
 
       }
       cmd = cmd << 1;
     }
+    Serial.println(F("Console Commands:"));
+    Serial.print(F("  - "));
+    Serial.print(FP(STR_CMD_ROLLUP));
+    Serial.println(F(" [day] [<result-lines>]   (0 -> all)"));
+    Serial.print(F("  - "));
+    Serial.print(FP(STR_CMD_FDR));
+    Serial.println(F(" [dump]   (dump -> binary)"));
+    Serial.print(F("  - "));
+    Serial.print(FP(STR_CMD_TIME));
+    Serial.println(F(" [HH:MM]"));
+    Serial.print(F("  - "));
+    Serial.print(FP(STR_CMD_SCHED));
+    Serial.println(F(" [set <slot> <HH:MM> <temp> | clr <slot>]"));
+    Serial.print(F("  - "));
+    Serial.print(FP(STR_CMD_WATCH));
+    Serial.println(F(" [<ms>|off]   (CSV line per status change)"));
+    Serial.print(F("  - "));
+    Serial.print(FP(STR_CMD_MACH));
+    Serial.println(F("   (binary frames until FRAME_EXIT)"));
     
   } else if (request == CMD_INFO_STAT) {
     Serial.print(F("State: "));
@@ -478,6 +857,62 @@ void ConsoleUI::provideUserInfo(BoilerStateAutomaton *automaton) {
       Serial.println(duration / 1000L);
     }
     
+    if (runtime->heaterControl->isTimeProportional()) {
+      Serial.print(F("Heater duty [per mille]: "));
+      Serial.print(runtime->heaterControl->duty);
+      Serial.print(F(", relay switches: "));
+      Serial.println(runtime->heaterControl->switches);
+    }
+    
+    TimeMillis uptime = millis();
+    Serial.print(F("Awake [%]: "));
+    Serial.print(uptime < 100L ? 100L : 100L - (long) (runtime->stats->sleepMillis / (uptime / 100L)));
+    Serial.print(F(", sleeping [s]: "));
+    Serial.print(runtime->stats->sleepMillis / 1000L);
+    Serial.print(F(" of "));
+    Serial.println(uptime / 1000L);
+    
+    Serial.print(F("Boot [ms]: "));
+    Serial.print(runtime->stats->initMillis);
+    Serial.print(F(", log restore [ms]: "));
+    Serial.print(runtime->stats->logInitMillis);
+    Serial.print(F(", first water temp [ms]: "));
+    Serial.print(runtime->stats->firstWaterTempMillis);
+    Serial.println(runtime->stats->warmRestart ? F(", warm restart") : F(""));
+    
+    Serial.print(F("Log index FRAM writes: "));
+    Serial.println(runtime->logIndex->writes);
+    
+    Serial.print(F("Energy [Wh]: session "));
+    Serial.print(runtime->energy->counters.sessionWh);
+    Serial.print(F(", day "));
+    if (runtime->energy->dayKnown()) {
+      Serial.print(runtime->energy->counters.dayWh);
+    } else {
+      Serial.print(F("- (time not set)"));
+    }
+    Serial.print(F(", lifetime "));
+    Serial.println(runtime->energy->counters.lifetimeWh);
+    
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+      const SensorQuality &quality = runtime->sensorReadout->quality[i];
+      Serial.print(i == 0 ? F("Water sensor readouts: ") : F("Ambient sensor readouts: "));
+      Serial.print(quality.readouts);
+      Serial.print(F(", failed "));
+      Serial.print(quality.failures);
+      Serial.print(F(", recovered "));
+      Serial.print(quality.recovered);
+      Serial.print(F(", max. retry [ms]: "));
+      Serial.println(quality.maxRetryMillis);
+    }
+    
+    if (freeMemory() >= 0) {
+      Serial.print(F("Free RAM [bytes]: "));
+      Serial.print(freeMemory());
+      Serial.print(F(", min. stack headroom [bytes]: "));
+      Serial.println(stackHeadroom());
+    }
+    
   } else if (request == CMD_INFO_LOG) {
     uint16_t entriesToReturn;
     if (op->request.intValue == 0) {
@@ -495,10 +930,15 @@ void ConsoleUI::provideUserInfo(BoilerStateAutomaton *automaton) {
     Serial.print(F("% full), showing "));
     Serial.println(entriesToReturn);
     
-    context->log->readMostRecentLogEntries(entriesToReturn);
-    LogEntry e;
-    while (context->log->nextLogEntry(e)) {
-      printLogEntry(&e);
+    if (logFilter >= 0) {
+      printFilteredLog(LogDataType(logFilter), entriesToReturn);
+      logFilter = -1;
+    } else {
+      context->log->readMostRecentLogEntries(entriesToReturn);
+      LogEntry e;
+      while (context->log->nextLogEntry(e)) {
+        printLogEntry(&e);
+      }
     }
     
   } else if (request == CMD_INFO_CONFIG) {
@@ -510,17 +950,239 @@ void ConsoleUI::provideUserInfo(BoilerStateAutomaton *automaton) {
       Serial.print(F(": "));
       Serial.println(getConfigParamValue(context->config, p, buf));
     }
+    for(uint8_t i=0; i<NUM_HEATER_CONTROL_PARAMS; i++) {
+      Serial.print(HEATER_CONTROL_PARAM_BASE_ID + i);
+      Serial.print(F(" - "));
+      Serial.print(getHeaterControlParamName(i));
+      Serial.print(F(": "));
+      Serial.println(runtime->heaterControl->getParam(i));
+    }
   }
   Serial.println();
 }
 
   
-void ConsoleUI::notifyStatusChange(StatusNotification *) {
+void ConsoleUI::notifyStatusChange(StatusNotification *notification) {
+  lastStatus = *notification;
+  if (machineMode) {
+    writeStatusFrame(notification);
+    return;
+  }
+  if (watchInterval > 0) {
+    // printed by the loop:
+    watchPending |= notification->notifyProperties;
+    return;
+  }
   Serial.println(F("* status notification"));
 }
 
-void ConsoleUI::notifyNewLogEntry(LogEntry) {
+void ConsoleUI::checkWatchLine() {
+  TimeMillis now = millis();
+  if (now - lastWatchLine < watchInterval) {
+    return;
+  }
+  int8_t heater = digitalRead(HEATER_PIN) == HIGH ? 1 : 0;
+  if (watchPending != NOTIFY_NONE || heater != watchHeater) {
+    printWatchLine(now, heater);
+  }
+}
+
+/*
+ * Prints the changed values only, the other columns are left empty.
+ */
+void ConsoleUI::printWatchLine(TimeMillis now, int8_t heater) {
+  StatusNotification *s = &lastStatus;
+  Serial.print(now);
+  Serial.print(',');
+  if (watchPending & NOTIFY_STATE) {
+    Serial.print(s->state.name());
+  }
+  Serial.print(',');
+  if (watchPending & NOTIFY_WATER_SENSOR) {
+    if (s->waterSensorStatus == DS18B20_SENSOR_OK) {
+      Serial.print(s->waterTemp);
+    } else {
+      Serial.print(getSensorStatusName((DS18B20_StatusEnum) s->waterSensorStatus));
+    }
+  }
+  Serial.print(',');
+  if (watchPending & NOTIFY_AMBIENT_SENSOR) {
+    if (s->ambientSensorStatus == DS18B20_SENSOR_OK) {
+      Serial.print(s->ambientTemp);
+    } else {
+      Serial.print(getSensorStatusName((DS18B20_StatusEnum) s->ambientSensorStatus));
+    }
+  }
+  Serial.print(',');
+  if (heater != watchHeater) {
+    Serial.print(heater);
+    watchHeater = heater;
+  }
+  Serial.print(',');
+  if (watchPending & NOTIFY_TIME_TO_GO) {
+    Serial.print(s->timeToGo);
+  }
+  Serial.println();
+  watchPending = NOTIFY_NONE;
+  lastWatchLine = now;
+}
+
+void ConsoleUI::notifyNewLogRecord(const LogEntry &, const uint8_t record[], uint8_t size) {
+  if (machineMode) {
+    if (size > 0) {
+      writeFrame(FRAME_LOG_ENTRY, record, size);
+    }
+    return;
+  }
+  if (watchInterval > 0) {
+    // keep the CSV stream clean
+    return;
+  }
   Serial.println(F("* new log entry"));
 }
 
 
+/*
+ * MACHINE MODE
+ */
+
+void ConsoleUI::writeFrame(FrameType type, const void *payload, uint8_t length) {
+  uint8_t header[3] = { FRAME_SYNC, type, length };
+  uint16_t crc = frameCRC(type, payload, length);
+  Serial.write(header, sizeof(header));
+  Serial.write((const uint8_t *) payload, length);
+  Serial.write((uint8_t) (crc & 0xFF));
+  Serial.write((uint8_t) (crc >> 8));
+}
+
+void ConsoleUI::writeStatusFrame(StatusNotification *notification) {
+  MachineStatus s;
+  s.notifyProperties = notification->notifyProperties;
+  s.state = notification->state.id();
+  s.acceptedUserCommands = notification->acceptedUserCommands;
+  s.timeInState = notification->timeInState;
+  s.heatingTime = notification->heatingTime;
+  s.timeToGo = notification->timeToGo;
+  s.waterSensorStatus = notification->waterSensorStatus;
+  s.waterTemp = notification->waterTemp;
+  s.ambientSensorStatus = notification->ambientSensorStatus;
+  s.ambientTemp = notification->ambientTemp;
+  writeFrame(FRAME_STATUS, &s, sizeof(MachineStatus));
+}
+
+void ConsoleUI::outputLogEntry(LogEntry *e) {
+  if (machineMode) {
+    uint8_t record[LOG_RECORD_MAX_SIZE];
+    uint8_t size = encodeLogRecord(*e, record);
+    if (size > 0) {
+      writeFrame(FRAME_LOG_ENTRY, record, size);
+    }
+  } else {
+    printLogEntry(e);
+  }
+}
+
+void ConsoleUI::readMachineRequest() {
+  UserRequest *request = &(context->op->request);
+  while (Serial.available()) {
+    if (!decoder.feed(Serial.read(), millis())) {
+      if (decoder.error != FRAME_ERROR_NONE) {
+        writeFrame(FRAME_ERROR, &decoder.error, sizeof(FrameError));
+        decoder.error = FRAME_ERROR_NONE;
+      }
+      continue;
+    }
+    
+    if (decoder.type == FRAME_EXIT && decoder.length == 0) {
+      machineMode = false;
+      uint8_t ok = true;
+      writeFrame(FRAME_ACK, &ok, sizeof(ok));
+      return;
+    }
+    if (decoder.type != FRAME_REQUEST || decoder.length != sizeof(MachineRequest)) {
+      FrameError error = decoder.type != FRAME_REQUEST ? FRAME_ERROR_TYPE : FRAME_ERROR_LENGTH;
+      writeFrame(FRAME_ERROR, &error, sizeof(FrameError));
+      continue;
+    }
+    
+    MachineRequest r;
+    memcpy(&r, decoder.payload, sizeof(MachineRequest));
+    if (! checkMachineRequest(r)) {
+      FrameError error = FRAME_ERROR_REQUEST;
+      writeFrame(FRAME_ERROR, &error, sizeof(FrameError));
+      continue;
+    }
+    if (r.command == CMD_CONFIG_SET_VALUE
+        && r.param >= HEATER_CONTROL_PARAM_BASE_ID && r.param < HEATER_CONTROL_PARAM_BASE_ID + NUM_HEATER_CONTROL_PARAMS) {
+      // heater-control params are not known to the automaton => apply directly:
+      commandExecuted(runtime->heaterControl->setParam(r.param - HEATER_CONTROL_PARAM_BASE_ID, r.intValue));
+      continue;
+    }
+    request->command = (UserCommandEnum) r.command;
+    request->intValue = r.intValue;
+    request->floatValue = r.floatValue;
+    if (r.command == CMD_INFO_LOG) {
+      logFilter = r.param <= (uint8_t) LogDataType::CONFIG ? r.param : -1;
+    } else {
+      request->param = ConfigParam(r.param);
+    }
+    // one request per loop iteration, the rest stays in the serial buffer:
+    return;
+  }
+}
+
+void ConsoleUI::provideMachineInfo(BoilerStateAutomaton *automaton) {
+  UserCommandEnum request = context->op->request.command;
+  OperationalParams *op = context->op;
+  
+  if (request == CMD_INFO_STAT) {
+    StatusNotification s = lastStatus;
+    s.notifyProperties = NOTIFY_NONE;
+    s.state = automaton->state()->id();
+    s.acceptedUserCommands = automaton->acceptedUserCommands();
+    s.timeInState = automaton->inStateMillis() / 1000L;
+    s.heatingTime = heatingTotalMillis(op) / 1000L;
+    s.waterSensorStatus = op->water.sensorStatus;
+    s.waterTemp = op->water.currentTemp;
+    s.ambientSensorStatus = op->ambient.sensorStatus;
+    s.ambientTemp = op->ambient.currentTemp;
+    writeStatusFrame(&s);
+    
+  } else if (request == CMD_INFO_LOG) {
+    uint16_t entriesToReturn = op->request.intValue < 0 ? 5 : op->request.intValue;
+    uint16_t entriesOutput = 0;
+    if (logFilter >= 0) {
+      entriesOutput = printFilteredLog(LogDataType(logFilter), entriesToReturn);
+      logFilter = -1;
+    } else {
+      context->log->readMostRecentLogEntries(entriesToReturn);
+      LogEntry e;
+      while (context->log->nextLogEntry(e)) {
+        outputLogEntry(&e);
+        entriesOutput++;
+      }
+    }
+    writeFrame(FRAME_END, &entriesOutput, sizeof(entriesOutput));
+    
+  } else if (request == CMD_INFO_CONFIG) {
+    ConfigBatchItem items[NUM_CONFIG_PARAMS + NUM_HEATER_CONTROL_PARAMS];
+    uint8_t n = 0;
+    for(uint8_t id=1; id<=NUM_CONFIG_PARAMS; id++) {
+      int32_t value;
+      if (getConfigBatchValue(context->config, id, value)) {
+        items[n].id = id;
+        items[n++].value = value;
+      }
+    }
+    for(uint8_t i=0; i<NUM_HEATER_CONTROL_PARAMS; i++) {
+      items[n].id = HEATER_CONTROL_PARAM_BASE_ID + i;
+      items[n++].value = runtime->heaterControl->getParam(i);
+    }
+    writeFrame(FRAME_CONFIG, items, n * sizeof(ConfigBatchItem));
+    
+  } else {
+    // nothing to return (help is text only):
+    uint16_t none = 0;
+    writeFrame(FRAME_END, &none, sizeof(none));
+  }
+}
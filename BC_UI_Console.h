@@ -2,12 +2,19 @@
   #define BC_UI_SER_H_INCLUDED
 
   #include "BC_UI.h"
+  #include "BC_Frame.h"
+
+  #define WATCH_DEFAULT_INTERVAL 1000L // [ms]
+  // status notifications are sent at most every MIN_USER_NOTIFICATION_INTERVAL:
+  #define WATCH_MIN_INTERVAL     1000L // [ms]
   
-  class ConsoleUI : public AbstractUI {
+  class ConsoleUI final : public AbstractUI {
     public:
       ConsoleUI() : AbstractUI() { }
       
       void readUserRequest();
+
+      boolean inputPending();
       
       void commandExecuted(boolean success);
       
@@ -15,7 +22,63 @@
     
       void notifyStatusChange(StatusNotification *notification);
     
-      void notifyNewLogEntry(LogEntry entry);
+      void notifyNewLogRecord(const LogEntry &entry, const uint8_t record[], uint8_t size);
+
+    protected:
+      // LogDataType of a filtered 'log' request, -1 -> all types:
+      int8_t logFilter = -1;
+
+      // returns the number of entries printed:
+      uint16_t printFilteredLog(LogDataType type, uint16_t entriesToReturn);
+
+      /*
+       * Executes commands that are handled by the console itself, i.e. not by the automaton.
+       * Returns false if cmd is not such a command.
+       */
+      boolean handleLocalCommand(const char cmd[], char args[]);
+
+      void printRollups(RollupPeriod period, uint16_t entriesToReturn);
+
+      /*
+       * 'time [HH:MM]', 'sched', 'sched set <slot> <HH:MM> <temp>', 'sched clr <slot>'.
+       * Returns false if cmd is not a schedule command.
+       */
+      boolean handleScheduleCommand(const char cmd[], char args[]);
+      void printSchedule();
+
+      void printFlightRecorder();
+      void dumpFlightRecorder();
+
+      /*
+       * Machine mode ('mach'): requests, responses and notifications are exchanged as binary frames (see BC_Frame.h)
+       * instead of text until the host sends FRAME_EXIT.
+       */
+      boolean machineMode = false;
+      FrameDecoder decoder;
+      // most recent status notification, returned for CMD_INFO_STAT in machine mode:
+      StatusNotification lastStatus;
+
+      /*
+       * Watch mode ('watch [<ms>]'): status notifications are turned into CSV lines instead of the usual
+       * message. Lines are printed from the loop at most every watchInterval [ms], notifications in between 
+       * are merged.
+       */
+      TimeMillis watchInterval = 0L;
+      TimeMillis lastWatchLine = 0L;
+      // properties changed since the most recent CSV line:
+      NotifyProperties watchPending = NOTIFY_NONE;
+      // heater state of the most recent CSV line (-1: none printed yet):
+      int8_t watchHeater = -1;
+
+      void checkWatchLine();
+      void printWatchLine(TimeMillis now, int8_t heater);
+
+      void readMachineRequest();
+      void provideMachineInfo(BoilerStateAutomaton *automaton);
+      void writeFrame(FrameType type, const void *payload, uint8_t length);
+      void writeStatusFrame(StatusNotification *notification);
+      // prints the entry or sends it as a frame in machine mode:
+      void outputLogEntry(LogEntry *e);
   };
   
 #endif
@@ -0,0 +1,97 @@
+#include "BC_UI_Multi.h"
+
+boolean MultiUI::add(AbstractUI *ui, TimeMillis minNotificationInterval) {
+  if (numBackends == MAX_UI_BACKENDS) {
+    return false;
+  }
+  Backend *b = &backends[numBackends++];
+  b->ui = ui;
+  b->minNotificationInterval = minNotificationInterval;
+  b->lastNotification = 0L;
+  b->pending = NOTIFY_NONE;
+  return true;
+}
+
+void MultiUI::init(ExecutionContext *context, RuntimeContext *runtime) {
+  AbstractUI::init(context, runtime);
+  for (uint8_t i = 0; i < numBackends; i++) {
+    backends[i].ui->init(context, runtime);
+  }
+}
+
+void MultiUI::readUserRequest() {
+  for (uint8_t n = 0; n < numBackends; n++) {
+    uint8_t i = nextReader;
+    nextReader = (nextReader + 1) % numBackends;
+    backends[i].ui->readUserRequest();
+    if (context->op->request.command != CMD_NONE) {
+      // don't let the other back-ends overwrite the request; they'll be read in the next loop iterations:
+      requester = i;
+      return;
+    }
+  }
+}
+
+boolean MultiUI::inputPending() {
+  for (uint8_t i = 0; i < numBackends; i++) {
+    if (backends[i].ui->inputPending()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TimeMillis MultiUI::maxIdleMillis() {
+  TimeMillis idle = AbstractUI::maxIdleMillis();
+  for (uint8_t i = 0; i < numBackends; i++) {
+    TimeMillis t = backends[i].ui->maxIdleMillis();
+    if (t < idle) {
+      idle = t;
+    }
+  }
+  return idle;
+}
+
+void MultiUI::update() {
+  // the current request (if any) has been processed:
+  requester = NO_REQUESTER;
+  for (uint8_t i = 0; i < numBackends; i++) {
+    backends[i].ui->update();
+  }
+}
+
+void MultiUI::commandExecuted(boolean success) {
+  if (requester != NO_REQUESTER) {
+    backends[requester].ui->commandExecuted(success);
+  }
+}
+
+void MultiUI::provideUserInfo(BoilerStateAutomaton *automaton) {
+  if (requester != NO_REQUESTER) {
+    backends[requester].ui->provideUserInfo(automaton);
+  }
+}
+
+void MultiUI::notifyStatusChange(StatusNotification *notification) {
+  TimeMillis now = millis();
+  NotifyProperties notify = notification->notifyProperties;
+  for (uint8_t i = 0; i < numBackends; i++) {
+    Backend *b = &backends[i];
+    b->pending |= notify;
+    if (b->lastNotification != 0L && now - b->lastNotification < b->minNotificationInterval) {
+      continue;
+    }
+    // the notification holds the current values of all properties => merged properties are up to date:
+    notification->notifyProperties = b->pending;
+    b->ui->notifyStatusChange(notification);
+    b->pending = NOTIFY_NONE;
+    b->lastNotification = now;
+  }
+  notification->notifyProperties = notify;
+}
+
+void MultiUI::notifyNewLogRecord(const LogEntry &entry, const uint8_t record[], uint8_t size) {
+  for (uint8_t i = 0; i < numBackends; i++) {
+    backends[i].ui->notifyNewLogRecord(entry, record, size);
+  }
+}
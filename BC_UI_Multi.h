@@ -0,0 +1,66 @@
+#ifndef BC_UI_MULTI_H_INCLUDED
+  #define BC_UI_MULTI_H_INCLUDED
+
+  #include "BC_UI.h"
+
+  #define MAX_UI_BACKENDS 2
+
+  /*
+   * Serves several UIs at once (e.g. Console and BLE):
+   * - notifications are encoded once (StatusNotification, log record) and forwarded to every back-end; each back-end
+   *   has its own min. status-notification interval, skipped notifications are merged into the next one,
+   * - user requests are read from one back-end at a time (round robin), so a request is never overwritten by
+   *   another back-end before the controller has processed it,
+   * - command feedback and user info go to the back-end the current request came from; commands injected by the
+   *   controller (preheat schedule, warm restart) have no requester, their feedback is not passed to any back-end
+   *   (the resulting state changes are notified to all of them),
+   * - every back-end is updated in every loop iteration.
+   */
+  class MultiUI final : public AbstractUI {
+    public:
+      MultiUI() : AbstractUI() { }
+
+      /*
+       * Adds a back-end; minNotificationInterval [ms] limits its rate of status notifications.
+       * Returns false if there's no room for another back-end.
+       */
+      boolean add(AbstractUI *ui, TimeMillis minNotificationInterval = 0L);
+
+      void init(ExecutionContext *context, RuntimeContext *runtime);
+
+      void readUserRequest();
+
+      boolean inputPending();
+
+      TimeMillis maxIdleMillis();
+
+      void update();
+
+      void commandExecuted(boolean success);
+
+      void provideUserInfo(BoilerStateAutomaton *automaton);
+
+      void notifyStatusChange(StatusNotification *notification);
+
+      void notifyNewLogRecord(const LogEntry &entry, const uint8_t record[], uint8_t size);
+
+    protected:
+      struct Backend {
+        AbstractUI *ui;
+        TimeMillis minNotificationInterval;
+        TimeMillis lastNotification;
+        // properties of notifications skipped due to the rate limit:
+        NotifyProperties pending;
+      };
+
+      Backend backends[MAX_UI_BACKENDS];
+      uint8_t numBackends = 0;
+      // back-end to read the next user request from:
+      uint8_t nextReader = 0;
+      // back-end the current user request came from (NO_REQUESTER: none, or the request was injected):
+      uint8_t requester = NO_REQUESTER;
+
+      static const uint8_t NO_REQUESTER = 0xFF;
+  };
+
+#endif
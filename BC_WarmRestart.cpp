@@ -0,0 +1,121 @@
+#include "BC_WarmRestart.h"
+
+// #define DEBUG_WARM_RESTART
+
+#if defined(__AVR__)
+  #include <avr/io.h>
+
+  // reset flags passed by optiboot in r2 (not initialised by the C runtime):
+  static uint8_t bootloaderResetFlags __attribute__((section(".noinit")));
+
+  void captureResetFlags(void) __attribute__((naked, used, section(".init0")));
+  void captureResetFlags(void) {
+    __asm__ __volatile__ ("sts %0, r2\n" : "=m" (bootloaderResetFlags) :);
+  }
+#endif
+
+ResetCause readResetCause() {
+  #if defined(__AVR__)
+    uint8_t flags = MCUSR;
+    MCUSR = 0;
+    if (flags == 0) {
+      flags = bootloaderResetFlags;
+    }
+    if (flags & _BV(WDRF)) {
+      return RESET_UNKNOWN;
+    } else if (flags & _BV(PORF)) {
+      return RESET_POWER_ON;
+    } else if (flags & _BV(BORF)) {
+      return RESET_BROWNOUT;
+    } else if (flags & _BV(EXTRF)) {
+      return RESET_EXTERNAL;
+    }
+  #elif defined(ARDUINO_ARCH_SAMD)
+    uint8_t flags = PM->RCAUSE.reg;
+    if (flags & PM_RCAUSE_POR) {
+      return RESET_POWER_ON;
+    } else if (flags & (PM_RCAUSE_BOD12 | PM_RCAUSE_BOD33)) {
+      return RESET_BROWNOUT;
+    } else if (flags & PM_RCAUSE_EXT) {
+      return RESET_EXTERNAL;
+    }
+  #endif
+  return RESET_UNKNOWN;
+}
+
+boolean WarmRestart::init(ExecutionContext *context, ResetCause cause) {
+  this->context = context;
+  resuming = cause == RESET_BROWNOUT && persistent.load(snapshot);
+  if (!resuming) {
+    // a stale snapshot must not be picked up by the next warm restart:
+    persistent.clear();
+    snapshot.state = States::INIT.id();
+    snapshot.loggingValues = false;
+    snapshot.originalTimeToGo = UNDEFINED_TIME_SECONDS;
+    snapshot.heatingMillis = 0L;
+  }
+  #ifdef DEBUG_WARM_RESTART
+    Serial.print(F("DEBUG_WARM_RESTART: reset cause "));
+    Serial.print(cause);
+    Serial.println(resuming ? F(", resuming") : F(", cold boot"));
+  #endif
+  return resuming;
+}
+
+UserCommandEnum WarmRestart::resumeCommand(BoilerStateAutomaton *automaton, TimeMillis now) {
+  if (!resuming) {
+    return CMD_NONE;
+  }
+  StateID current = automaton->state()->id();
+  boolean recPending = snapshot.loggingValues && !context->op->loggingValues;
+  boolean heatPending = snapshot.state == States::HEATING.id() && current != States::HEATING;
+  if ((current == States::INIT || recPending || heatPending) && now < WARM_RESTART_RESUME_TIMEOUT) {
+    // commands not accepted (yet), e.g. while the sensors are initialising or NOK, are retried until the timeout:
+    UserCommands accepted = automaton->acceptedUserCommands();
+    if (current == States::INIT) {
+      return CMD_NONE;
+    } else if (recPending) {
+      return (accepted & CMD_REC_ON) ? CMD_REC_ON : CMD_NONE;
+    } else {
+      return (accepted & CMD_HEAT_ON) ? CMD_HEAT_ON : CMD_NONE;
+    }
+  }
+  finishResume(automaton, now);
+  return CMD_NONE;
+}
+
+void WarmRestart::finishResume(BoilerStateAutomaton *automaton, TimeMillis now) {
+  resuming = false;
+  OperationalParams *op = context->op;
+  if (op->loggingValues == snapshot.loggingValues) {
+    op->heatingAccumulatedMillis = snapshot.heatingMillis;
+    if (automaton->state()->id() == States::HEATING) {
+      // the heating period in progress started with the resume:
+      op->heatingStartMillis = now;
+    }
+    op->originalTimeToGo = snapshot.originalTimeToGo;
+  }
+  context->log->logMessage(static_cast<T_Message_ID>(BC_Msg::WARM_RESTART), automaton->state()->id().id(),
+                           snapshot.heatingMillis / 60000L);
+  lastSave = now;
+}
+
+void WarmRestart::update(BoilerStateAutomaton *automaton, TimeMillis now) {
+  if (resuming || now - lastSave < WARM_RESTART_SAVE_INTERVAL) {
+    return;
+  }
+  OperationalParams *op = context->op;
+  T_State_ID state = automaton->state()->id().id();
+  TimeMillis heatingMillis = heatingTotalMillis(op);
+  if (state == snapshot.state && op->loggingValues == snapshot.loggingValues
+      && op->originalTimeToGo == snapshot.originalTimeToGo
+      && heatingMillis - snapshot.heatingMillis < WARM_RESTART_HEATING_DELTA) {
+    return;
+  }
+  snapshot.state = state;
+  snapshot.loggingValues = op->loggingValues;
+  snapshot.originalTimeToGo = op->originalTimeToGo;
+  snapshot.heatingMillis = heatingMillis;
+  persistent.save(snapshot);
+  lastSave = now;
+}
@@ -0,0 +1,83 @@
+#ifndef BC_WARM_RESTART_H_INCLUDED
+  #define BC_WARM_RESTART_H_INCLUDED
+
+  #include <BC_Control.h>
+  #include <BC_State.h>
+  #include "BC_Persistent.h"
+  #include "BC_Messages.h"
+
+  #define WARM_RESTART_SAVE_INTERVAL      5000L // [ms] min. time between two snapshot writes
+  #define WARM_RESTART_HEATING_DELTA     30000L // [ms] heating time progress alone is saved only in steps of this size
+  #define WARM_RESTART_RESUME_TIMEOUT   120000L // [ms] give up resuming if the automaton doesn't get there in time
+
+  /*
+   * The sketch neither enables the watchdog nor resets itself, so watchdog and software resets (e.g. the reset
+   * before an upload) count as RESET_UNKNOWN.
+   */
+  enum ResetCause : uint8_t {
+    RESET_UNKNOWN = 0,
+    RESET_POWER_ON,
+    RESET_EXTERNAL,
+    RESET_BROWNOUT
+  };
+
+  /*
+   * Reads (and clears) the MCU's reset cause. Call once, early during boot. A power-on takes precedence over the
+   * other causes, since the brown-out flag may be set as well while the supply ramps up.
+   * On AVR, optiboot clears MCUSR before starting the sketch and passes the flags in r2; they are captured in .init0
+   * before the C runtime touches r2. Without a bootloader, MCUSR is read instead.
+   */
+  ResetCause readResetCause();
+
+  /*
+   * The part of the OperationalParams that is needed to continue after a reset.
+   */
+  struct OperationalSnapshot {
+    T_State_ID state;
+    boolean loggingValues;
+    TimeSeconds originalTimeToGo;
+    TimeMillis heatingMillis;
+  };
+
+  #define WARM_RESTART_STORE_SIZE (PersistentBlock<OperationalSnapshot>::STORE_SIZE)
+
+  /*
+   * Warm restart after a brownout: the operational state is snapshotted to FRAM
+   * (double-buffered, only when it has changed and at most every WARM_RESTART_SAVE_INTERVAL). After such a reset,
+   * the controller resumes by issuing the user commands that lead back to the snapshotted state (rec on, heat on)
+   * as soon as the automaton accepts them, then restores the heating time and the original time to go.
+   * After any other reset, the snapshot is discarded and the controller starts from scratch. There is no RTC, so
+   * the age of the snapshot cannot be checked: a snapshot is only ever resumed by the boot directly following the
+   * run that wrote it, since every cold boot clears it.
+   */
+  class WarmRestart {
+    public:
+      WarmRestart(FRAMStore *store) : persistent(store) {}
+
+      /*
+       * Returns true if the controller is going to resume from a snapshot.
+       */
+      boolean init(ExecutionContext *context, ResetCause cause);
+
+      /*
+       * Call while there is no pending user request: returns the next command to resume the snapshotted state,
+       * CMD_NONE if there is none (yet).
+       */
+      UserCommandEnum resumeCommand(BoilerStateAutomaton *automaton, TimeMillis now);
+
+      /*
+       * Call from every loop iteration.
+       */
+      void update(BoilerStateAutomaton *automaton, TimeMillis now);
+
+    protected:
+      PersistentBlock<OperationalSnapshot> persistent;
+      ExecutionContext *context = NULL;
+      OperationalSnapshot snapshot;
+      boolean resuming = false;
+      TimeMillis lastSave = 0L;
+
+      void finishResume(BoilerStateAutomaton *automaton, TimeMillis now);
+  };
+
+#endif
@@ -1,8 +1,11 @@
 #include "BC_Controller.h"
 
-// Uncomment AT MOST ONE (!) of the following lines:
+// Uncomment one or both of the following lines (both => the UIs are served simultaneously), or pass -DBLE_UI and/or
+// -DCONSOLE_UI to the compiler (see extras/size_report.sh):
+#if ! defined BLE_UI && ! defined CONSOLE_UI
   #define BLE_UI
   //#define CONSOLE_UI
+#endif
 
 // Comment the following line to prevent waiting for the serial connection:
   #define WAIT_FOR_SERIAL
@@ -10,20 +13,38 @@
      
 #if defined CONSOLE_UI
   #include "BC_UI_Console.h"
-#elif defined BLE_UI
+#endif
+#if defined BLE_UI
   #include "BC_UI_BLE.h"
 #endif
 
-BC_Controller controller = BC_Controller();
-
-#if defined BLE_UI
-  BLEUI ui = BLEUI();
+#if defined BLE_UI && defined CONSOLE_UI
+  #include "BC_UI_Multi.h"
+  #define CONSOLE_NOTIFICATION_INTERVAL 5000L // [ms]
+  typedef MultiUI UI;
+  BLEUI bleUI = BLEUI();
+  ConsoleUI consoleUI = ConsoleUI();
+#elif defined BLE_UI
+  typedef BLEUI UI;
 #elif defined CONSOLE_UI
-  ConsoleUI ui = ConsoleUI();
+  typedef ConsoleUI UI;
+#endif
+
+// all objects are placed statically, nothing is allocated on the heap:
+UI ui = UI();
+BC_Controller<UI> controller = BC_Controller<UI>(&ui);
+
+#if defined BLE_UI && defined CONSOLE_UI
+  static_assert(sizeof(ui) + sizeof(bleUI) + sizeof(consoleUI) <= RAM_BUDGET_UI, "UI exceeds its RAM budget");
+#else
+  static_assert(sizeof(ui) <= RAM_BUDGET_UI, "UI exceeds its RAM budget");
 #endif
+static_assert(sizeof(controller) <= RAM_BUDGET_CONTROLLER, "controller exceeds its RAM budget");
 
 
 void setup() {
+  paintStack();
+  
   #ifdef WAIT_FOR_SERIAL
     Serial.begin(115200);
     while (!Serial) {
@@ -32,7 +53,11 @@ void setup() {
   #endif
   Serial.println(F("Controller Starting up ..."));
 
-  controller.init(&ui);
+  #if defined BLE_UI && defined CONSOLE_UI
+    ui.add(&bleUI);
+    ui.add(&consoleUI, CONSOLE_NOTIFICATION_INTERVAL);
+  #endif
+  controller.init();
   
   Serial.println(F("Controller ready."));
 }
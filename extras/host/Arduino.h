@@ -0,0 +1,52 @@
+#ifndef HOST_ARDUINO_H_INCLUDED
+  #define HOST_ARDUINO_H_INCLUDED
+
+  /*
+   * Minimal Arduino core for building the sketch's pure functions (decoders, codecs, fixed-point math) on the host,
+   * see build.sh. Only what those sources and the library headers they include need; nothing here touches hardware.
+   */
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <ctype.h>
+  #include <math.h>
+
+  typedef bool boolean;
+  typedef uint8_t byte;
+
+  #define HIGH 1
+  #define LOW 0
+  #define INPUT 0
+  #define OUTPUT 1
+  #define DEC 10
+  #define HEX 16
+
+  #define PROGMEM
+  typedef const char *PGM_P;
+  class __FlashStringHelper;
+  #define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+  #define pgm_read_byte(p) (*(const uint8_t *) (p))
+  #define pgm_read_word(p) (*(const uint16_t *) (p))
+  #define memcpy_P memcpy
+  #define strcpy_P strcpy
+  #define strncpy_P strncpy
+  #define strcmp_P strcmp
+  #define strncmp_P strncmp
+  #define strlen_P strlen
+
+  // host time, set by the harness:
+  extern unsigned long hostMillis;
+  inline unsigned long millis() { return hostMillis; }
+  inline unsigned long micros() { return hostMillis * 1000UL; }
+  inline void delay(unsigned long ms) { hostMillis += ms; }
+  inline void pinMode(uint8_t, uint8_t) { }
+  inline void digitalWrite(uint8_t, uint8_t) { }
+  inline int digitalRead(uint8_t) { return LOW; }
+  inline void noInterrupts() { }
+  inline void interrupts() { }
+
+  template<class T> T min(T a, T b) { return a < b ? a : b; }
+  template<class T> T max(T a, T b) { return a > b ? a : b; }
+  template<class T> T constrain(T a, T l, T h) { return a < l ? l : (a > h ? h : a); }
+
+#endif
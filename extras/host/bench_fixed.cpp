@@ -0,0 +1,64 @@
+/*
+ * Cost of the time-to-go math per call, fixed point (heatingEnergy() / power, as in originalTimeToGo()) against the
+ * float formula it replaced, and of formatting / parsing a config value. Build and run:
+ *
+ *   extras/host/build.sh bench
+ *   extras/host/bench_fixed [calls]
+ *
+ * Host numbers: the ratio between the variants is what matters, the MCU has no FPU and pays far more for float.
+ */
+#include "BC_Fixed.h"
+#include <stdio.h>
+#include <time.h>
+
+unsigned long hostMillis = 0UL;
+
+// keeps the compiler from optimising the loops away:
+static volatile int64_t sink;
+
+static double seconds() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static TimeSeconds fixedTimeToGo(uint32_t capacity, uint32_t power, int32_t delta) {
+  return heatingEnergy(capacity, delta) / power;
+}
+
+static TimeSeconds floatTimeToGo(float capacity, float power, float delta) {
+  // [l] * [°C] * [J / (kg * K)] / [W]
+  return capacity * delta * 4186.0f / power;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t calls = argc > 1 ? atol(argv[1]) : 10000000UL;
+  volatile uint32_t capacity = 80000L;
+  volatile uint32_t power = 2000L;
+
+  double start = seconds();
+  for (uint32_t i = 0; i < calls; i++) {
+    sink += fixedTimeToGo(capacity, power, (int32_t) (i & 0x1FFF));
+  }
+  double fixedNs = (seconds() - start) * 1e9 / calls;
+
+  start = seconds();
+  for (uint32_t i = 0; i < calls; i++) {
+    sink += floatTimeToGo(capacity / 1000.0f, (float) power, (i & 0x1FFF) / 100.0f);
+  }
+  double floatNs = (seconds() - start) * 1e9 / calls;
+
+  char buf[13];
+  int32_t value;
+  start = seconds();
+  for (uint32_t i = 0; i < calls / 10; i++) {
+    parseFixed(formatFixed((int32_t) i, 2, buf), 2, INT32_MIN, INT32_MAX, value);
+    sink += value;
+  }
+  double formatParseNs = (seconds() - start) * 1e9 / (calls / 10);
+
+  printf("time to go, fixed point:  %8.2f ns/call\n", fixedNs);
+  printf("time to go, float:        %8.2f ns/call\n", floatNs);
+  printf("formatFixed + parseFixed: %8.2f ns/call\n", formatParseNs);
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Throughput of the input decoders in requests per second, per input path (see input_targets.h). Build and run:
+ *
+ *   extras/host/build.sh bench
+ *   extras/host/bench_input [seconds per path]
+ *
+ * The inputs are valid requests, i.e. the decoders run to completion. The numbers are host numbers: compare them
+ * before and after a change, don't read them as MCU timings.
+ */
+#include "input_targets.h"
+#include <stdio.h>
+#include <time.h>
+
+unsigned long hostMillis = 0UL;
+
+#define BENCH_INPUTS 4
+
+static const char *PATH_NAMES[NUM_INPUT_PATHS] = {
+  "user command", "target temp", "rollup", "flight recorder", "config batch", "console line", "machine frames"
+};
+
+struct BenchInput {
+  uint8_t data[64];
+  uint8_t size;
+};
+
+static void makeInputs(InputPath path, BenchInput inputs[BENCH_INPUTS]) {
+  for (uint8_t i = 0; i < BENCH_INPUTS; i++) {
+    BenchInput *in = &inputs[i];
+    uint8_t *d = in->data + 1;
+    in->data[0] = path;
+    switch (path) {
+      case INPUT_USER_COMMAND: {
+        T_UserCommand_ID cmd = CMD_HEAT_ON << (i % 2);
+        memcpy(d, &cmd, sizeof(cmd));
+        in->size = 1 + sizeof(cmd);
+        break;
+      }
+      case INPUT_TARGET_TEMP: {
+        ACF_Temperature t = 4000 + i * 500;
+        memcpy(d, &t, sizeof(t));
+        in->size = 1 + sizeof(t);
+        break;
+      }
+      case INPUT_ROLLUP:
+        d[0] = i % 2;
+        d[1] = i;
+        d[2] = 0;
+        in->size = 4;
+        break;
+      case INPUT_FLIGHT_RECORDER:
+        d[0] = i * 4;
+        d[1] = 0;
+        in->size = 3;
+        break;
+      case INPUT_CONFIG_BATCH: {
+        ConfigBatchItem items[2] = { { (uint8_t) ConfigParam::TARGET_TEMP, (int32_t) (5000 + i) }, { (uint8_t) ConfigParam::HEATER_POWER, 2000L } };
+        d[0] = 0;
+        memcpy(d + 1, items, sizeof(items));
+        in->size = 2 + sizeof(items);
+        break;
+      }
+      case INPUT_CONSOLE_LINE: {
+        static const char *LINES[BENCH_INPUTS] = { "config set 1 55.5\n", "log 20\r\n", "rollup 0 12\n", "stat\n" };
+        in->size = 1 + strlen(LINES[i]);
+        memcpy(d, LINES[i], in->size - 1);
+        break;
+      }
+      default: {
+        MachineRequest r = { CMD_CONFIG_SET_VALUE, (uint8_t) ConfigParam::TANK_CAPACITY, 0L, 80000.0f + i };
+        uint8_t n = encodeRequestFrame(r, d);
+        MachineRequest heat = { CMD_HEAT_ON, 0, 0L, 0.0f };
+        in->size = 1 + n + encodeRequestFrame(heat, d + n);
+        break;
+      }
+    }
+  }
+}
+
+static double seconds() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  double duration = argc > 1 ? atof(argv[1]) : 1.0;
+  for (uint8_t path = 0; path < NUM_INPUT_PATHS; path++) {
+    BenchInput inputs[BENCH_INPUTS];
+    makeInputs(InputPath(path), inputs);
+    uint64_t requests = 0;
+    uint64_t rounds = 0;
+    double start = seconds();
+    double elapsed;
+    do {
+      for (uint16_t n = 0; n < 1000; n++) {
+        const BenchInput *in = &inputs[rounds++ % BENCH_INPUTS];
+        requests += decodeInput(in->data, in->size);
+      }
+      elapsed = seconds() - start;
+    } while (elapsed < duration);
+    if (requests == 0) {
+      fprintf(stderr, "%s: no request accepted\n", PATH_NAMES[path]);
+      return 1;
+    }
+    printf("%-16s %12.0f requests/s\n", PATH_NAMES[path], requests / elapsed);
+  }
+  return 0;
+}
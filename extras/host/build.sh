@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Builds the host tools in this directory from the sketch sources:
+#
+#   extras/host/build.sh fuzz    libFuzzer harness over the BLE and console input decoders (clang, ASan + UBSan)
+#   extras/host/build.sh bench   throughput benchmark of the same decoders, cost of the fixed-point math
+#   extras/host/build.sh test    host tests of the pure functions (test_*.cpp), built and run
+#
+# The control libraries (BC_Control, ACF_*) are taken from ARDUINO_LIBS (default: ~/Arduino/libraries); their
+# Arduino core is the minimal host one in this directory.
+
+cd "$(dirname "$0")" || exit 1
+HOST_DIR=$(pwd)
+SKETCH_DIR=$(cd ../.. && pwd)
+ARDUINO_LIBS=${ARDUINO_LIBS:-$HOME/Arduino/libraries}
+
+INCLUDES="-I$HOST_DIR -I$SKETCH_DIR"
+for lib in "$ARDUINO_LIBS"/*; do
+  if [ -d "$lib/src" ]; then INCLUDES="$INCLUDES -I$lib/src"; else INCLUDES="$INCLUDES -I$lib"; fi
+done
+
+# the sketch sources the tools need; --gc-sections drops the parts that would pull in the rest of the libraries:
+SOURCES="$SKETCH_DIR/BC_InputDecoder.cpp $SKETCH_DIR/BC_ConfigBatch.cpp $SKETCH_DIR/BC_Frame.cpp
+  $SKETCH_DIR/BC_Fixed.cpp $SKETCH_DIR/BC_LogRecord.cpp $SKETCH_DIR/BC_Persistent.cpp
+  $SKETCH_DIR/BC_Sensors.cpp $SKETCH_DIR/BC_SensorReadout.cpp $SKETCH_DIR/BC_Energy.cpp"
+FLAGS="-std=gnu++11 -Wall -Wextra -ffunction-sections -fdata-sections -Wl,--gc-sections $INCLUDES"
+
+case "$1" in
+  fuzz)
+    ${CXX:-clang++} $FLAGS -g -O1 -fsanitize=fuzzer,address,undefined -fno-sanitize-recover=all fuzz_input.cpp $SOURCES -o fuzz_input
+    ;;
+  bench)
+    ${CXX:-c++} $FLAGS -O2 bench_input.cpp $SOURCES -o bench_input \
+      && ${CXX:-c++} $FLAGS -O2 bench_fixed.cpp $SOURCES -o bench_fixed
+    ;;
+  test)
+    ${CXX:-c++} $FLAGS -g -O1 -fsanitize=address,undefined -fno-sanitize-recover=all host_tests.cpp test_*.cpp $SOURCES -o host_tests \
+      && ./host_tests
+    ;;
+  *)
+    echo "usage: $0 fuzz|bench|test" >&2
+    exit 2
+    ;;
+esac
@@ -0,0 +1,83 @@
+/*
+ * libFuzzer harness over the input decoders of the BLE and console UIs (see input_targets.h). Build and run:
+ *
+ *   extras/host/build.sh fuzz
+ *   extras/host/fuzz_input -max_len=64 [corpus dir]
+ *
+ * Before fuzzing, every UserCommandEnum literal and every ConfigParam is run through the decoders once with a valid
+ * and an out-of-range value, so both are covered regardless of what the fuzzer finds.
+ */
+#include "input_targets.h"
+
+unsigned long hostMillis = 0UL;
+
+static const UserCommandEnum COMMANDS[] = {
+  CMD_INFO_HELP, CMD_INFO_STAT, CMD_INFO_CONFIG, CMD_INFO_LOG, CMD_CONFIG_SET_VALUE, CMD_CONFIG_SWAP_IDS,
+  CMD_CONFIG_CLEAR_IDS, CMD_CONFIG_ACK_IDS, CMD_CONFIG_RESET_ALL, CMD_REC_ON, CMD_REC_OFF, CMD_HEAT_ON, CMD_HEAT_OFF,
+  CMD_HEAT_RESET
+};
+
+static uint16_t decodeFrame(const MachineRequest &r) {
+  uint8_t input[1 + FRAME_OVERHEAD + sizeof(MachineRequest)];
+  input[0] = INPUT_MACHINE_FRAMES;
+  return decodeInput(input, 1 + encodeRequestFrame(r, input + 1));
+}
+
+static void checkCommands() {
+  for (uint8_t i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]); i++) {
+    uint8_t input[1 + sizeof(T_UserCommand_ID)] = { INPUT_USER_COMMAND };
+    T_UserCommand_ID id = COMMANDS[i];
+    memcpy(input + 1, &id, sizeof(id));
+    CHECK(decodeInput(input, sizeof(input)) == 1);
+
+    MachineRequest r = { id, 0, 0L, 0.0f };
+    if (COMMANDS[i] == CMD_CONFIG_SET_VALUE) {
+      r.param = (uint8_t) ConfigParam::TARGET_TEMP;
+    }
+    CHECK(decodeFrame(r) == 1);
+  }
+  // not a single command:
+  MachineRequest r = { CMD_HEAT_ON | CMD_HEAT_OFF, 0, 0L, 0.0f };
+  CHECK(decodeFrame(r) == 0);
+}
+
+static void checkConfigParams() {
+  for (uint8_t id = (uint8_t) ConfigParam::TARGET_TEMP; id <= (uint8_t) ConfigParam::HEATER_POWER; id++) {
+    ConfigParam param = ConfigParam(id);
+    boolean batchable = param != ConfigParam::WATER_TEMP_SENSOR_ID && param != ConfigParam::AMBIENT_TEMP_SENSOR_ID;
+    MachineRequest r = { CMD_CONFIG_SET_VALUE, id, 1L, 1.0f };
+    CHECK(decodeFrame(r) == (batchable ? 1 : 0));
+    if (param == ConfigParam::TANK_CAPACITY || param == ConfigParam::HEATER_POWER) {
+      float max = param == ConfigParam::TANK_CAPACITY ? MAX_TANK_CAPACITY : MAX_HEATER_POWER;
+      r.floatValue = max;
+      CHECK(decodeFrame(r) == 1);
+      r.floatValue = max + 1.0f;
+      CHECK(decodeFrame(r) == 0);
+      r.floatValue = 1.5f;
+      CHECK(decodeFrame(r) == 0);
+    } else {
+      r.intValue = -1L;
+      CHECK(decodeFrame(r) == 0);
+    }
+
+    uint8_t input[1 + 1 + sizeof(ConfigBatchItem)] = { INPUT_CONFIG_BATCH, 0 };
+    ConfigBatchItem item = { id, 1L };
+    memcpy(input + 2, &item, sizeof(item));
+    CHECK(decodeInput(input, sizeof(input)) == 1);
+  }
+  for (uint8_t id = HEATER_CONTROL_PARAM_BASE_ID; id < HEATER_CONTROL_PARAM_BASE_ID + NUM_HEATER_CONTROL_PARAMS; id++) {
+    MachineRequest r = { CMD_CONFIG_SET_VALUE, id, 1L, 0.0f };
+    CHECK(decodeFrame(r) == 1);
+  }
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***) {
+  checkCommands();
+  checkConfigParams();
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  decodeInput(data, size);
+  return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef HOST_TEST_H_INCLUDED
+  #define HOST_TEST_H_INCLUDED
+
+  #include <stdio.h>
+
+  /*
+   * Minimal self-registering tests of the sketch's pure functions, run by host_tests.cpp (see build.sh):
+   *
+   *   HOST_TEST(parsesNegativeFraction) {
+   *     EXPECT(parseFixed("-1.5", 1, -100, 100, v) && v == -15);
+   *   }
+   */
+  typedef void (*HostTestFunction)();
+
+  struct HostTest {
+    const char *name;
+    HostTestFunction run;
+    HostTest *next;
+
+    static HostTest *first;
+    static unsigned failures;
+
+    HostTest(const char *name, HostTestFunction run) : name(name), run(run), next(first) {
+      first = this;
+    }
+  };
+
+  inline void hostExpect(bool ok, const char *expr, const char *file, int line) {
+    if (!ok) {
+      printf("  FAILED %s:%d: %s\n", file, line, expr);
+      HostTest::failures++;
+    }
+  }
+
+  #define HOST_TEST(name) \
+    static void name(); \
+    static HostTest name##Test(#name, name); \
+    static void name()
+
+  #define EXPECT(cond) hostExpect((cond), #cond, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Runs all HOST_TESTs linked in (test_*.cpp):
+ *
+ *   extras/host/build.sh test
+ */
+#include "host_test.h"
+
+unsigned long hostMillis = 0UL;
+
+HostTest *HostTest::first = NULL;
+unsigned HostTest::failures = 0;
+
+int main() {
+  unsigned tests = 0;
+  unsigned failed = 0;
+  for (HostTest *t = HostTest::first; t != NULL; t = t->next) {
+    unsigned failures = HostTest::failures;
+    t->run();
+    tests++;
+    if (HostTest::failures != failures) {
+      printf("%s failed\n", t->name);
+      failed++;
+    }
+  }
+  printf("%u tests, %u failed\n", tests, failed);
+  return failed == 0 ? 0 : 1;
+}
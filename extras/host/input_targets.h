@@ -0,0 +1,153 @@
+#ifndef HOST_INPUT_TARGETS_H_INCLUDED
+  #define HOST_INPUT_TARGETS_H_INCLUDED
+
+  #include "BC_InputDecoder.h"
+  #include "BC_Fixed.h"
+  #include "BC_HeaterControl.h"
+
+  /*
+   * The input paths of the UIs as seen by the fuzzer and the benchmark: the first byte of an input selects the path,
+   * the rest is the raw data (a GATT write, a console line or a byte stream in machine mode). Returns the number of
+   * requests accepted; aborts if a decoder passes on anything it should have rejected.
+   */
+  typedef enum {
+    INPUT_USER_COMMAND = 0,   // USER_REQUEST_CID
+    INPUT_TARGET_TEMP,        // TARGET_TEMP_CID
+    INPUT_ROLLUP,             // ROLLUP_CID
+    INPUT_FLIGHT_RECORDER,    // FLIGHT_RECORDER_CID
+    INPUT_CONFIG_BATCH,       // CONFIG_BATCH_CID
+    INPUT_CONSOLE_LINE,       // console, text mode
+    INPUT_MACHINE_FRAMES,     // console, machine mode
+    NUM_INPUT_PATHS
+  } InputPath;
+
+  #define HOST_USER_CMD_MAX_SIZE   (sizeof(T_UserCommand_ID) + 8)  // see USER_CMD_PARAMETER_MAX_SIZE
+  #define HOST_CMD_LINE_BUF_SIZE   24                              // see CMD_LINE_BUF_SIZE
+
+  #define CHECK(cond) do { if (!(cond)) abort(); } while (0)
+
+  inline uint16_t decodeConsoleLine(const uint8_t data[], size_t len) {
+    char line[HOST_CMD_LINE_BUF_SIZE + 1];
+    uint8_t count = len < HOST_CMD_LINE_BUF_SIZE ? len : HOST_CMD_LINE_BUF_SIZE;
+    memcpy(line, data, count);
+    line[count] = '\0';
+    uint8_t n = normalizeCommandLine(line, count);
+    CHECK(n <= count && line[n] == '\0');
+    char *args;
+    uint8_t cmdLen = splitCommandLine(line, "abcdefghijklmnopqrstuvwxyz?", &args);
+    CHECK(cmdLen <= n && args >= line && args <= line + n);
+    if (cmdLen == 0) {
+      return 0;
+    }
+    // every arg as an int, then the first one as a temperature:
+    uint16_t accepted = 1;
+    char *arg = args;
+    int32_t value;
+    while (*arg != '\0' && parseIntArg(arg, -1000, 1000, value, &arg)) {
+      CHECK(value >= -1000 && value <= 1000);
+      CHECK(arg >= line && arg <= line + n);
+    }
+    if (parseFixed(args, 2, 0, 10000, value)) {
+      CHECK(value >= 0 && value <= 10000);
+      accepted++;
+    }
+    return accepted;
+  }
+
+  inline uint16_t decodeMachineFrames(const uint8_t data[], size_t len) {
+    FrameDecoder decoder;
+    uint16_t accepted = 0;
+    for (size_t i = 0; i < len; i++) {
+      // one byte per ms:
+      if (! decoder.feed(data[i], i)) {
+        continue;
+      }
+      CHECK(decoder.length <= FRAME_MAX_REQUEST_PAYLOAD);
+      if (decoder.type != FRAME_REQUEST || decoder.length != sizeof(MachineRequest)) {
+        continue;
+      }
+      MachineRequest r;
+      memcpy(&r, decoder.payload, sizeof(MachineRequest));
+      if (! checkMachineRequest(r)) {
+        continue;
+      }
+      CHECK(isUserCommand(r.command));
+      if (r.command == CMD_CONFIG_SET_VALUE && r.param < HEATER_CONTROL_PARAM_BASE_ID) {
+        ConfigParam param = ConfigParam(r.param);
+        if (param == ConfigParam::TANK_CAPACITY || param == ConfigParam::HEATER_POWER) {
+          CHECK(configValueInRange(r.param, (int32_t) r.floatValue));
+        } else {
+          CHECK(configValueInRange(r.param, r.intValue));
+        }
+      }
+      accepted++;
+    }
+    return accepted;
+  }
+
+  inline uint16_t decodeInput(const uint8_t input[], size_t size) {
+    if (size == 0) {
+      return 0;
+    }
+    const uint8_t *data = input + 1;
+    uint16_t len = size - 1 > UINT16_MAX ? UINT16_MAX : size - 1;
+    switch (input[0] % NUM_INPUT_PATHS) {
+      case INPUT_USER_COMMAND: {
+        UserCommandEnum cmd;
+        if (decodeUserCommand(data, len, HOST_USER_CMD_MAX_SIZE, cmd)) {
+          CHECK(isUserCommand(cmd) && len <= HOST_USER_CMD_MAX_SIZE);
+          return 1;
+        }
+        return 0;
+      }
+      case INPUT_TARGET_TEMP: {
+        ACF_Temperature temp;
+        if (decodeTargetTemp(data, len, temp)) {
+          CHECK(configValueInRange((uint8_t) ConfigParam::TARGET_TEMP, temp));
+          return 1;
+        }
+        return 0;
+      }
+      case INPUT_ROLLUP: {
+        RollupPeriod period;
+        uint16_t age;
+        if (decodeRollupSelection(data, len, period, age)) {
+          CHECK(period == ROLLUP_HOUR || period == ROLLUP_DAY);
+          return 1;
+        }
+        return 0;
+      }
+      case INPUT_FLIGHT_RECORDER: {
+        uint16_t index;
+        return decodeFlightRecorderSelection(data, len, index) ? 1 : 0;
+      }
+      case INPUT_CONFIG_BATCH: {
+        uint8_t flags;
+        ConfigBatchItem items[CONFIG_BATCH_MAX_ITEMS];
+        int8_t n = decodeConfigBatchFragment(data, len, CONFIG_BATCH_MAX_ITEMS, flags, items);
+        CHECK(n <= CONFIG_BATCH_MAX_ITEMS);
+        CHECK(n < 0 || len == 1 + n * sizeof(ConfigBatchItem));
+        return n > 0 ? n : 0;
+      }
+      case INPUT_CONSOLE_LINE:
+        return decodeConsoleLine(data, len);
+      default:
+        return decodeMachineFrames(data, len);
+    }
+  }
+
+  /*
+   * Writes the frame of a MachineRequest to buf (FRAME_OVERHEAD + sizeof(MachineRequest) bytes).
+   */
+  inline uint8_t encodeRequestFrame(const MachineRequest &r, uint8_t buf[]) {
+    buf[0] = FRAME_SYNC;
+    buf[1] = FRAME_REQUEST;
+    buf[2] = sizeof(MachineRequest);
+    memcpy(buf + 3, &r, sizeof(MachineRequest));
+    uint16_t crc = frameCRC(FRAME_REQUEST, &r, sizeof(MachineRequest));
+    buf[3 + sizeof(MachineRequest)] = crc & 0xFF;
+    buf[4 + sizeof(MachineRequest)] = crc >> 8;
+    return FRAME_OVERHEAD + sizeof(MachineRequest);
+  }
+
+#endif
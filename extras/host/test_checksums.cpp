@@ -0,0 +1,31 @@
+#include "host_test.h"
+#include "BC_Persistent.h"
+
+static uint32_t fnv1aString(const char *s) {
+  return fnv1a((const uint8_t *) s, strlen(s));
+}
+
+HOST_TEST(fnv1aMatchesReferenceValues) {
+  EXPECT(fnv1aString("") == FNV_OFFSET_BASIS);
+  EXPECT(fnv1aString("a") == 0xE40C292CUL);
+  EXPECT(fnv1aString("foobar") == 0xBF9CF968UL);
+}
+
+HOST_TEST(fnv1aContinuesAcrossCalls) {
+  // the GATT layout hash is built piecewise (device name, service UUID, characteristics):
+  EXPECT(fnv1a((const uint8_t *) "bar", 3, fnv1aString("foo")) == fnv1aString("foobar"));
+}
+
+HOST_TEST(fnv1aDetectsLayoutChanges) {
+  // e.g. a characteristic's max. length changed from 16 to 20 bytes:
+  uint8_t layout[] = { 0x01, 0x20, 0x0A, 0x01, 0x10 };
+  uint32_t hash = fnv1a(layout, sizeof(layout));
+  layout[4] = 0x14;
+  EXPECT(fnv1a(layout, sizeof(layout)) != hash);
+}
+
+HOST_TEST(crc16MatchesReferenceValue) {
+  // CRC-16/CCITT-FALSE check value:
+  EXPECT(crc16((const uint8_t *) "123456789", 9) == 0x29B1);
+  EXPECT(crc16((const uint8_t *) "", 0) == 0xFFFF);
+}
@@ -0,0 +1,39 @@
+#include "host_test.h"
+#include "BC_Energy.h"
+
+HOST_TEST(accumulatesFullWattHours) {
+  uint32_t remainder = 0L;
+  // 2 kW for one hour:
+  EXPECT(accumulateWh(remainder, 2000L, 3600000L) == 2000L);
+  EXPECT(remainder == 0L);
+  // 1 W for one second is 1 J, far below a Wh:
+  EXPECT(accumulateWh(remainder, 1L, 1000L) == 0L);
+  EXPECT(remainder == 1000L);
+}
+
+HOST_TEST(losesNoEnergyWhenIntegratedInSlices) {
+  // a heater switched by the time-proportional control: 2 kW, on for 7 s of every 60 s window, for one day:
+  uint32_t remainder = 0L;
+  uint32_t wh = 0L;
+  for (uint16_t window = 0; window < 24 * 60; window++) {
+    wh += accumulateWh(remainder, 2000L, 7000L);
+  }
+  // 2 kW * 24 * 60 * 7 s = 20160 kJ = 5600 Wh
+  EXPECT(wh == 5600L && remainder == 0L);
+
+  // integrated every loop iteration (10 ms) while on for 37 min 13 s:
+  remainder = 0L;
+  wh = 0L;
+  for (uint32_t t = 0; t < 2233000L; t += 10L) {
+    wh += accumulateWh(remainder, 3500L, 10L);
+  }
+  uint32_t whole = 0L;
+  EXPECT(wh == accumulateWh(whole, 3500L, 2233000L) && remainder == whole);
+}
+
+HOST_TEST(handlesLongPeriodsAtMaxPower) {
+  uint32_t remainder = MILLIJOULES_PER_WH - 1L;
+  // 100 kW for 49 days doesn't overflow the intermediate [mJ]:
+  EXPECT(accumulateWh(remainder, MAX_HEATER_POWER, 49L * 24L * 3600000L) == 117600000L);
+  EXPECT(remainder == MILLIJOULES_PER_WH - 1L);
+}
@@ -0,0 +1,63 @@
+#include "host_test.h"
+#include "BC_Fixed.h"
+
+static boolean parsesTo(const char *s, uint8_t decimals, int32_t expected) {
+  int32_t value;
+  return parseFixed(s, decimals, INT32_MIN, INT32_MAX, value) && value == expected;
+}
+
+static boolean formatsTo(int32_t value, uint8_t decimals, const char *expected) {
+  char buf[13];
+  return strcmp(formatFixed(value, decimals, buf), expected) == 0;
+}
+
+HOST_TEST(parsesFixedPointNumbers) {
+  EXPECT(parsesTo("55", 2, 5500));
+  EXPECT(parsesTo("55.5", 2, 5550));
+  EXPECT(parsesTo("-0.25", 2, -25));
+  EXPECT(parsesTo("+7", 0, 7));
+  EXPECT(parsesTo(".5", 1, 5));
+  EXPECT(parsesTo("80000 rest", 0, 80000));
+}
+
+HOST_TEST(roundsSurplusFractionDigits) {
+  EXPECT(parsesTo("1.005", 2, 101));
+  EXPECT(parsesTo("1.0049", 2, 100));
+  EXPECT(parsesTo("-1.005", 2, -101));
+  EXPECT(parsesTo("2000.7", 0, 2001));
+}
+
+HOST_TEST(rejectsMalformedNumbers) {
+  int32_t value = 42;
+  EXPECT(! parseFixed("", 2, INT32_MIN, INT32_MAX, value));
+  EXPECT(! parseFixed("-", 2, INT32_MIN, INT32_MAX, value));
+  EXPECT(! parseFixed("1.2.3", 2, INT32_MIN, INT32_MAX, value));
+  EXPECT(! parseFixed("12x", 2, INT32_MIN, INT32_MAX, value));
+  EXPECT(! parseFixed("99999999999", 0, INT32_MIN, INT32_MAX, value));
+  EXPECT(! parseFixed("101", 0, 0, 100, value));
+  EXPECT(value == 42);
+}
+
+HOST_TEST(formatsFixedPointNumbers) {
+  EXPECT(formatsTo(-1234, 2, "-12.34"));
+  EXPECT(formatsTo(5, 2, "0.05"));
+  EXPECT(formatsTo(0, 0, "0"));
+  EXPECT(formatsTo(INT32_MAX, 0, "2147483647"));
+  EXPECT(formatsTo(INT32_MIN, 2, "-21474836.48"));
+}
+
+HOST_TEST(formattedNumbersParseBack) {
+  char buf[13];
+  for (int32_t v = -100000L; v <= 100000L; v += 997L) {
+    EXPECT(parsesTo(formatFixed(v, 2, buf), 2, v));
+  }
+}
+
+HOST_TEST(computesHeatingEnergy) {
+  // 80 l by 10 K: 80 kg * 10 K * 4186 J / (kg * K)
+  EXPECT(heatingEnergy(80000L, 1000L) == 3348800L);
+  EXPECT(heatingEnergy(80000L, -1000L) == -3348800L);
+  EXPECT(heatingEnergy(0L, 1000L) == 0L);
+  // the largest tank by 100 K doesn't overflow:
+  EXPECT(heatingEnergy(MAX_TANK_CAPACITY, 10000L) == 418600000L);
+}
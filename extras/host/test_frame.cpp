@@ -0,0 +1,117 @@
+#include "host_test.h"
+#include "BC_Frame.h"
+#include "BC_LogRecord.h"
+
+/*
+ * Feeds the bytes one per ms starting at now; returns the number of complete frames.
+ */
+static uint8_t feed(FrameDecoder &decoder, const uint8_t bytes[], uint8_t n, TimeMillis now = 1000L) {
+  uint8_t frames = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (decoder.feed(bytes[i], now + i)) {
+      frames++;
+    }
+  }
+  return frames;
+}
+
+static uint8_t encodeFrame(uint8_t type, const void *payload, uint8_t length, uint8_t frame[]) {
+  frame[0] = FRAME_SYNC;
+  frame[1] = type;
+  frame[2] = length;
+  if (length > 0) {
+    memcpy(frame + 3, payload, length);
+  }
+  uint16_t crc = frameCRC(type, payload, length);
+  frame[3 + length] = crc & 0xFF;
+  frame[4 + length] = crc >> 8;
+  return FRAME_OVERHEAD + length;
+}
+
+HOST_TEST(decodesRequestFrames) {
+  MachineRequest r = { CMD_CONFIG_SET_VALUE, 1, 5500L, 0.0f };
+  uint8_t frame[FRAME_OVERHEAD + sizeof(MachineRequest)];
+  uint8_t n = encodeFrame(FRAME_REQUEST, &r, sizeof(r), frame);
+  FrameDecoder decoder;
+  EXPECT(feed(decoder, frame, n) == 1);
+  EXPECT(decoder.type == FRAME_REQUEST && decoder.length == sizeof(MachineRequest));
+  EXPECT(memcmp(decoder.payload, &r, sizeof(r)) == 0);
+  EXPECT(decoder.error == FRAME_ERROR_NONE);
+}
+
+HOST_TEST(decodesEmptyFrames) {
+  uint8_t frame[FRAME_OVERHEAD];
+  uint8_t n = encodeFrame(FRAME_EXIT, NULL, 0, frame);
+  FrameDecoder decoder;
+  EXPECT(feed(decoder, frame, n) == 1);
+  EXPECT(decoder.type == FRAME_EXIT && decoder.length == 0);
+}
+
+HOST_TEST(resynchronizesAfterGarbage) {
+  uint8_t bytes[3 + FRAME_OVERHEAD];
+  bytes[0] = 0x00;
+  bytes[1] = 0x42;
+  bytes[2] = 0xFF;
+  encodeFrame(FRAME_EXIT, NULL, 0, bytes + 3);
+  FrameDecoder decoder;
+  EXPECT(feed(decoder, bytes, sizeof(bytes)) == 1);
+}
+
+HOST_TEST(rejectsCorruptedFrames) {
+  MachineRequest r = { CMD_HEAT_ON, 0, 0L, 0.0f };
+  uint8_t frame[FRAME_OVERHEAD + sizeof(MachineRequest)];
+  uint8_t n = encodeFrame(FRAME_REQUEST, &r, sizeof(r), frame);
+  frame[4] ^= 0x01;
+  FrameDecoder decoder;
+  EXPECT(feed(decoder, frame, n) == 0);
+  EXPECT(decoder.error == FRAME_ERROR_CRC);
+  // the next frame is received again:
+  frame[4] ^= 0x01;
+  EXPECT(feed(decoder, frame, n) == 1);
+}
+
+HOST_TEST(rejectsOverlongFrames) {
+  uint8_t header[3] = { FRAME_SYNC, FRAME_REQUEST, FRAME_MAX_REQUEST_PAYLOAD + 1 };
+  FrameDecoder decoder;
+  EXPECT(feed(decoder, header, sizeof(header)) == 0);
+  EXPECT(decoder.error == FRAME_ERROR_LENGTH);
+}
+
+HOST_TEST(discardsStalledFrames) {
+  MachineRequest r = { CMD_HEAT_ON, 0, 0L, 0.0f };
+  uint8_t frame[FRAME_OVERHEAD + sizeof(MachineRequest)];
+  uint8_t n = encodeFrame(FRAME_REQUEST, &r, sizeof(r), frame);
+  FrameDecoder decoder;
+  EXPECT(feed(decoder, frame, 5, 1000L) == 0);
+  EXPECT(feed(decoder, frame + 5, n - 5, 1005L + FRAME_BYTE_TIMEOUT) == 0);
+  EXPECT(decoder.error == FRAME_ERROR_TIMEOUT);
+}
+
+HOST_TEST(encodesLogRecords) {
+  LogEntry e;
+  memset(&e, 0, sizeof(LogEntry));
+  e.timestamp = 0x01020304;
+  e.type = (T_LogDataType) LogDataType::CONFIG;
+  LogConfigParamData config = { 1, 55.5f };
+  memcpy(&e.data, &config, sizeof(config));
+  uint8_t record[LOG_RECORD_MAX_SIZE];
+  uint8_t size = encodeLogRecord(e, record);
+  #ifdef LOG_RECORD_COMPACT
+    EXPECT(size == logRecordSize(LogDataType::CONFIG));
+    EXPECT(record[0] == ((LOG_RECORD_VERSION << 4) | (uint8_t) LogDataType::CONFIG));
+  #else
+    EXPECT(size == sizeof(LogEntry) && memcmp(record, &e, sizeof(LogEntry)) == 0);
+  #endif
+
+  e.type = 0x0F;
+  EXPECT(encodeLogRecord(e, record) == 0);
+}
+
+HOST_TEST(roundsConfigValuesOfLogRecords) {
+  LogConfigParamData config = { 1, 55.555f };
+  EXPECT(logConfigValue(config) == 5556);
+  config.newValue = -0.004f;
+  EXPECT(logConfigValue(config) == 0);
+  config.newValue = -12.346f;
+  EXPECT(logConfigValue(config) == -1235);
+}
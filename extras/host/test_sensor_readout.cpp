@@ -0,0 +1,34 @@
+#include "host_test.h"
+#include "BC_SensorReadout.h"
+
+HOST_TEST(detectsThePowerOnValue) {
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE] = { 0 };
+  scratchpad[0] = 0x50;
+  scratchpad[1] = 0x05;  // 85 °C
+  EXPECT(ds18b20PowerOnValue(scratchpad));
+  scratchpad[0] = 0x51;  // 85.0625 °C, a real readout
+  EXPECT(!ds18b20PowerOnValue(scratchpad));
+  scratchpad[0] = 0x50;
+  scratchpad[1] = 0x04;
+  EXPECT(!ds18b20PowerOnValue(scratchpad));
+}
+
+HOST_TEST(medianRejectsASingleSpike) {
+  const ACF_Temperature samples[] = { 2500, 8500, 2506, 2494, 2512 };
+  EXPECT(medianTemperature(samples, 5) == 2506);
+  EXPECT(medianTemperature(samples, 3) == 2506);
+  EXPECT(medianTemperature(samples, 4) == (2506 + 2500) / 2);
+}
+
+HOST_TEST(trimmedMeanDropsTheExtremes) {
+  const ACF_Temperature samples[] = { 2500, 8500, 2506, 2494, -1000 };
+  EXPECT(trimmedMeanTemperature(samples, 5) == 2500);
+  EXPECT(trimmedMeanTemperature(samples, 3) == 2506);
+}
+
+HOST_TEST(filtersLeaveTheSamplesUnchanged) {
+  const ACF_Temperature samples[] = { 3000, 1000, 2000 };
+  medianTemperature(samples, 3);
+  trimmedMeanTemperature(samples, 3);
+  EXPECT(samples[0] == 3000 && samples[1] == 1000 && samples[2] == 2000);
+}
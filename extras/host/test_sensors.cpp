@@ -0,0 +1,34 @@
+#include "host_test.h"
+#include "BC_Sensors.h"
+#include "BC_CutOutGuard.h"
+
+static void setScratchpad(uint8_t scratchpad[], int16_t raw, DS18B20_Resolution resolution) {
+  memset(scratchpad, 0, DS18B20_SCRATCHPAD_SIZE);
+  scratchpad[0] = raw & 0xFF;
+  scratchpad[1] = (raw >> 8) & 0xFF;
+  scratchpad[4] = resolution;
+}
+
+HOST_TEST(convertsFullResolutionTemperatures) {
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  setScratchpad(scratchpad, 0x0191, DS18B20_RESOLUTION_12_BIT);  // 25.0625 °C
+  EXPECT(ds18b20Temperature(scratchpad) == 2506);
+  setScratchpad(scratchpad, (int16_t) 0xFF5E, DS18B20_RESOLUTION_12_BIT);  // -10.125 °C
+  EXPECT(ds18b20Temperature(scratchpad) == -1012);
+}
+
+HOST_TEST(ignoresUndefinedBitsOfFastReadouts) {
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  // the guard reads at FAST_CUT_OUT_RESOLUTION, the 3 low bits are undefined at 9 bit:
+  setScratchpad(scratchpad, 0x0197, FAST_CUT_OUT_RESOLUTION);
+  EXPECT(ds18b20Temperature(scratchpad) == 2500);
+  setScratchpad(scratchpad, 0x0197, DS18B20_RESOLUTION_10_BIT);
+  EXPECT(ds18b20Temperature(scratchpad) == 2525);
+}
+
+HOST_TEST(fastReadoutsConvertFasterThanRegularOnes) {
+  // worst-case detection latency of the guard: one interval plus one fast conversion, well below a sensor cycle:
+  EXPECT(ds18b20ConversionMillis(FAST_CUT_OUT_RESOLUTION) == 94L);
+  EXPECT(ds18b20ConversionMillis(DS18B20_RESOLUTION_12_BIT) == 750L);
+  EXPECT(FAST_CUT_OUT_INTERVAL + ds18b20ConversionMillis(FAST_CUT_OUT_RESOLUTION) < 1000L);
+}
@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# Size report per build target: builds the sketch for each board and UI configuration with arduino-cli and
+# prints the flash and SRAM use, followed by the largest objects in SRAM.
+#
+# Usage: extras/size_report.sh [<fqbn> ...]   (default: Feather 32u4 and Feather M0)
+#
+# Requires arduino-cli with the board cores and the control libraries installed.
+
+cd "$(dirname "$0")/.." || exit 1
+SKETCH_DIR=$(pwd)
+BOARDS=${*:-"adafruit:avr:feather32u4 adafruit:samd:adafruit_feather_m0"}
+TOP=${TOP:-12}  # largest objects listed per build
+
+rc=0
+for fqbn in $BOARDS; do
+  for ui in BLE_UI CONSOLE_UI "BLE_UI CONSOLE_UI"; do
+    flags=""
+    for d in $ui; do flags="$flags -D$d"; done
+    out=$(mktemp -d)
+    echo "=== $fqbn: $ui"
+    if ! arduino-cli compile --fqbn "$fqbn" --build-property "compiler.cpp.extra_flags=$flags" \
+        --output-dir "$out" "$SKETCH_DIR" > "$out/compile.log" 2>&1; then
+      # e.g. a RAM budget static_assert:
+      grep -E "error" "$out/compile.log"
+      rc=1
+      continue
+    fi
+    grep -E "^(Sketch uses|Global variables use)" "$out/compile.log"
+    elf=$(ls "$out"/*.elf)
+    case $fqbn in
+      *:avr:*) nm=avr-nm ;;
+      *) nm=arm-none-eabi-nm ;;
+    esac
+    if command -v $nm > /dev/null; then
+      echo "largest objects in SRAM [bytes] (largest last):"
+      $nm -C -S --size-sort "$elf" | grep -E " [bBdD] " | tail -n "$TOP" | \
+        while read -r addr size type name; do printf "  %6d  %s\n" "0x$size" "$name"; done
+    fi
+    rm -rf "$out"
+  done
+done
+exit $rc